@@ -49,6 +49,7 @@
 #include "opt.h"
 #include "lefdefIO.h"
 #include "routeOpt.h"
+#include "wlen.h"
 
 
 void initGlobalVars() {
@@ -84,6 +85,16 @@ void initGlobalVars() {
   densityDP = 0.0f;
   routeMaxDensity = 0.99f;
   isBinSet = false;
+  isBinAuto = false;
+  isWlenSimd = false;
+  isWlenNetGrad = false;
+  highFanoutThres = 0;
+  wlenModel = WA;
+  isDeterministic = false;
+  isOverlapUpdate = false;
+  specStepCnt = 0;
+  ckptIter = 0;
+  resumeFile = "";
   isSkipIP = false;
 
   isVerbose = false;
@@ -114,6 +125,7 @@ void initGlobalVars() {
   isOnlyLGinDP = (isRoutability) ? true : false;
 
   numThread = 1;  // default
+  wlenThread = binThread = 1;
   hasUnitNetWeight = false;
   hasCustomNetWeight = false;
   netWeight = 1.00;
@@ -351,6 +363,7 @@ bool argument(int argc, char *argv[]) {
       i++;
       if(argv[i][0] != '-') {
         numThread = atoi(argv[i]);
+        wlenThread = binThread = numThread;
       }
       else {
         printf("\n**ERROR: Option %s requires thread number\n", argv[i - 1]);
@@ -924,6 +937,86 @@ bool argument(int argc, char *argv[]) {
         return false;
       }
     }
+    else if(!strcmp(argv[i], "-binAuto")) {
+      isBinAuto = true;
+    }
+    else if(!strcmp(argv[i], "-wlSimd")) {
+      isWlenSimd = true;
+    }
+    else if(!strcmp(argv[i], "-wlNetGrad")) {
+      isWlenNetGrad = true;
+    }
+    else if(!strcmp(argv[i], "-wlmodel")) {
+      i++;
+      if(!strcmp(argv[i], "wa")) {
+        wlenModel = WA;
+      }
+      else if(!strcmp(argv[i], "lse")) {
+        wlenModel = LSE;
+      }
+      else if(!strcmp(argv[i], "stn")) {
+        wlenModel = STN;
+      }
+      else {
+        printf("\n**ERROR: Option %s requires wa, lse or stn.\n",
+               argv[i - 1]);
+        return false;
+      }
+    }
+    else if(!strcmp(argv[i], "-det")) {
+      isDeterministic = true;
+    }
+    else if(!strcmp(argv[i], "-overlap")) {
+      isOverlapUpdate = true;
+    }
+    else if(!strcmp(argv[i], "-specStep")) {
+      i++;
+      if(argv[i][0] != '-') {
+        specStepCnt = atoi(argv[i]);
+        if(specStepCnt > SPEC_STEP_MAX_CNT) {
+          printf("\n**ERROR: Option %s takes at most %d candidates.\n",
+                 argv[i - 1], SPEC_STEP_MAX_CNT);
+          return false;
+        }
+      }
+      else {
+        printf("\n**ERROR: Option %s requires candidate count (INT).\n",
+               argv[i - 1]);
+        return false;
+      }
+    }
+    else if(!strcmp(argv[i], "-ckpt")) {
+      i++;
+      if(argv[i][0] != '-') {
+        ckptIter = atoi(argv[i]);
+      }
+      else {
+        printf("\n**ERROR: Option %s requires iteration interval (INT).\n",
+               argv[i - 1]);
+        return false;
+      }
+    }
+    else if(!strcmp(argv[i], "-resume")) {
+      i++;
+      if(argv[i][0] != '-') {
+        resumeFile = argv[i];
+      }
+      else {
+        printf("\n**ERROR: Option %s requires *.ckpt.\n", argv[i - 1]);
+        return false;
+      }
+    }
+    else if(!strcmp(argv[i], "-hfNet")) {
+      i++;
+      if(argv[i][0] != '-') {
+        highFanoutThres = atoi(argv[i]);
+      }
+      else {
+        printf("\n**ERROR: Option %s requires fanout threshold (INT).\n",
+               argv[i - 1]);
+        return false;
+      }
+    }
     else if(!strcmp(argv[i], "-x")) {
       i++;
       if(argv[i][0] != '-') {
@@ -1019,9 +1112,44 @@ void printUsage() {
   cout << "  -den        : Target Density, Floating number, Default = 1 "
           "[0.00,1.00]"
        << endl;
-  cout << "  -bin        : #bins (in power of 2) for x, y, z Directions"
+  cout << "  -bin        : #bins for x, y, z Directions (powers of 2 are "
+          "fastest, then 2/3/5-smooth sizes)"
        << endl;
   cout << "              : Unsigned Integer[3], Default = 32 32 32" << endl;
+  cout << "  -binAuto    : Pick a rectangular 2/3/5-smooth bin grid by "
+          "FFT cost (ignored with -bin)"
+       << endl;
+  cout << "  -wlSimd     : Vectorized WA wirelength kernel with an accurate "
+          "exp (compare against the default fastExp path)"
+       << endl;
+  cout << "  -wlNetGrad  : Emit WA pin gradients in the net pass and reduce "
+          "them per cell"
+       << endl;
+  cout << "  -wlmodel    : Wirelength model, wa / lse / stn (Steiner-scaled "
+          "WA, needs POWV9.dat / PORT9.dat in the working directory), "
+          "Default = wa"
+       << endl;
+  cout << "  -hfNet      : Approximate WA of nets above this fanout by the 16 "
+          "pins nearest each bbox side (re-selected whenever a pin moves); "
+          "the other pins get no wirelength gradient, Default = 0 (off)"
+       << endl;
+  cout << "  -det        : Deterministic mode, results independent of -t "
+          "(fixed density scatter parts, FFTW by estimate)"
+       << endl;
+  cout << "  -overlap    : Run the net update and the density update "
+          "concurrently, splitting -t between them"
+       << endl;
+  cout << "  -specStep   : Try this many Nesterov step sizes (2 or 3) "
+          "concurrently on -t / n threads each and keep the first that "
+          "passes the backtracking test (cGP2D, needs -t >= n), "
+          "Default = 0 (off)"
+       << endl;
+  cout << "  -ckpt       : Write <output>/<bench>_gp.ckpt every this many "
+          "Nesterov iterations, Default = 0 (off)"
+       << endl;
+  cout << "  -resume     : Restart global placement from a *.ckpt written "
+          "by -ckpt (same input and options)"
+       << endl;
   cout << "  -overflow   : Overflow Termination Condition, Floating Number, "
           "Default = 0.1 [0.00, 1.00]"
        << endl;
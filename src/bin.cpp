@@ -44,6 +44,7 @@
 #include <cstring>
 #include <ctgmath>
 #include <string>
+#include <utility>
 #include <omp.h>
 
 #include "bin.h"
@@ -74,6 +75,33 @@ static prec *bin_share_x_st;
 static prec *bin_share_y_st;
 static prec *bin_share_st;
 
+// tier->cell_st split into std cells / macros (base) and fillers.
+// bin_base_frozen: the base part of cell_area is up to date and the
+// filler-only phase may skip it.
+static CELL **bin_base_st = NULL;
+static CELL **bin_filler_st = NULL;
+static int bin_base_cnt = 0;
+static int bin_filler_cnt = 0;
+static int bin_cell_cap = 0;
+static bool bin_base_frozen = false;
+
+static void ApplyDiffArea(TIER *tier);
+static bool GetAutoBinDim(TIER *tier, int idealBinCnt, POS *dim);
+
+// the tier's own density context: its overlap cache and the
+// thread-private area planes of the parallel scatter. grid and engine
+// are bound by bin_update7_cGP2D.
+static BIN_CTX bin_ctx = {};
+
+static void BinUpdateCGP2D(BIN_CTX *ctx, TIER *tier, bool isFillerOnly);
+static void BinOvlpBuild(BIN_CTX *ctx, TIER *tier, bool isFillerOnly);
+static void BinScatterCells(BIN_CTX *ctx, TIER *tier, CELL **cells, int cnt,
+                            prec *dest);
+static void BinPrivInit(BIN_CTX *ctx, TIER *tier, int planeCnt);
+static void DenComp2D(CELL *cell, TIER *tier, FPOS pmin, FPOS pmax,
+                      prec *cellArea, prec *cellArea2, int *ovlpBin,
+                      prec *ovlpShare);
+
 FPOS bin_org;
 FPOS bin_stp;
 FPOS inv_bin_stp;
@@ -238,6 +266,77 @@ void bin_init() {
   bin_share_st = (prec *)malloc(sizeof(prec) * tot_bin_cnt);
 }
 
+// relative cost of one 1D DCT of length n; 0 if n is not 5-smooth.
+// Power-of-two lengths run the lane-parallel radix-4 FFT (fftv.cpp), which
+// vectorizes across lines; the others run the scalar mixed-radix FFT
+// (fftmr.cpp), weighted per stage, with the generic radix-5 butterfly the
+// most expensive.
+static prec GetDctCost(int n) {
+  if(IsPow2(n)) {
+    return n * log2((prec)n);
+  }
+  prec stage = 0;
+  int m = n;
+  while(m % 4 == 0) {
+    stage += 2.0;
+    m /= 4;
+  }
+  while(m % 2 == 0) {
+    stage += 1.0;
+    m /= 2;
+  }
+  while(m % 3 == 0) {
+    stage += 1.6;
+    m /= 3;
+  }
+  while(m % 5 == 0) {
+    stage += 5.0;
+    m /= 5;
+  }
+  return (m == 1) ? 2.0 * n * stage : 0;
+}
+
+// cheapest 5-smooth grid whose bin count lies in
+// [BIN_AUTO_MIN_FILL, 1] * idealBinCnt with near-square bins
+//
+static bool GetAutoBinDim(TIER *tier, int idealBinCnt, POS *dim) {
+  prec bestCost = PREC_MAX;
+  int minCnt = (int)(BIN_AUTO_MIN_FILL * idealBinCnt);
+
+  for(int nx = 4; nx <= BIN_AUTO_MAX_DIM; nx++) {
+    prec costX = GetDctCost(nx);
+    if(costX == 0) {
+      continue;
+    }
+    for(int ny = 4; ny <= BIN_AUTO_MAX_DIM && nx * ny <= idealBinCnt; ny++) {
+      if(nx * ny < minCnt) {
+        continue;
+      }
+      prec costY = GetDctCost(ny);
+      if(costY == 0) {
+        continue;
+      }
+      prec aspect = (tier->size.x / nx) / (tier->size.y / ny);
+      if(aspect > BIN_AUTO_MAX_ASPECT || aspect < 1.0 / BIN_AUTO_MAX_ASPECT) {
+        continue;
+      }
+      prec cost = ny * costX + nx * costY;
+      if(cost < bestCost) {
+        bestCost = cost;
+        dim->x = nx;
+        dim->y = ny;
+      }
+    }
+  }
+
+  if(bestCost == PREC_MAX) {
+    return false;
+  }
+  printf("INFO:  auto bin grid %d x %d (ideal %d bins)\n", dim->x, dim->y,
+         idealBinCnt);
+  return true;
+}
+
 //
 // mainly update
 //
@@ -274,6 +373,12 @@ void bin_init_2D(int STAGE) {
       tier->dim_bin.x = tier->dim_bin.y = 1024;
     }
 
+    // rectangular, mixed-radix friendly grid
+    POS autoDim;
+    if(isBinAuto && GetAutoBinDim(tier, ideal_bin_cnt, &autoDim)) {
+      tier->dim_bin = autoDim;
+    }
+
     if(STAGE == mGP2D) {
       if(dim_bin_mGP2D.x < tier->dim_bin.x)
         dim_bin_mGP2D.x = tier->dim_bin.x;
@@ -453,6 +558,10 @@ void bin_init_2D(int STAGE) {
     }
   }
 
+  for(int z = 0; z < numLayer; z++) {
+    den_grid_init(&tier_st[z]);
+  }
+
   // check
   //    TIER* tier = &tier_st[0];
   //    for(int i=0; i<tier->tot_bin_cnt; i++) {
@@ -510,6 +619,15 @@ void bin_delete(void) {
   free(bin_share_x_st);
   free(bin_share_y_st);
   free(bin_share_st);
+
+  bin_priv_delete();
+  bin_ovlp_delete();
+
+  free(bin_base_st);
+  free(bin_filler_st);
+  bin_base_st = bin_filler_st = NULL;
+  bin_base_cnt = bin_filler_cnt = bin_cell_cap = 0;
+  bin_base_frozen = false;
 }
 
 // min_a <= a && a <= max_a
@@ -863,57 +981,54 @@ void bin_update7(int N) {
 }*/
 
 void bin_update7_mGP2D() {
-  BIN *bp = NULL;
   CELL *cell = NULL;
   TIER *tier = NULL;
-  prec area_num = 0;
-  prec area_num2 = 0;
-  prec ovf_cell_den = 0;
-  prec ovf_cell_area = 0;
-  prec sum_ovf_area = 0;
+  prec_acc sum_ovf_area = 0;
 
   gsum_ovf_area = 0;
   gsum_phi = 0;
 
+  // potn_grad_2D must not reuse footprints from another stage
+  bin_ctx.ovlp.is_valid = false;
+
   for(int z = 0; z < numLayer; z++) {
     tier = &tier_st[z];
+    DEN_GRID *grid = tier->den_grid;
+
+    memset(grid->cell_area, 0, sizeof(prec) * grid->cnt);
+    memset(grid->cell_area2, 0, sizeof(prec) * grid->cnt);
 
-    for(int i = 0; i < tier->tot_bin_cnt; i++) {
-      bp = &tier->bin_mat[i];
-      bp->cell_area = 0;
-      bp->cell_area2 = 0;
-    }
     for(int i = 0; i < tier->cell_cnt; i++) {
       cell = tier->cell_st[i];
       den_comp_2d_mGP2D(cell, tier);
     }
-    for(int i = 0; i < tier->tot_bin_cnt; i++) {
-      bp = &tier->bin_mat[i];
-      area_num2 = bp->cell_area + bp->virt_area + bp->term_area;
-      area_num = area_num2 + bp->cell_area2;
-      bp->den = area_num * tier->inv_bin_area;
-      bp->den2 = area_num2 * tier->inv_bin_area;
-
-      copy_den_to_fft_2D(bp->den, bp->p);
+    bool isLargeUsed = grid->is_diff_used;
+    if(isLargeUsed) {
+      ApplyDiffArea(tier);
+    }
+    for(int i = 0; i < grid->cnt; i++) {
+      prec area_num2 = grid->cell_area[i] + grid->fixed_area[i];
+      grid->den[i] = (area_num2 + grid->cell_area2[i]) * tier->inv_bin_area;
+      grid->den2[i] = area_num2 * tier->inv_bin_area;
     }
 
     charge_fft_call(0);
     sum_ovf_area = 0;
 
-    for(int i = 0; i < tier->tot_bin_cnt; i++) {
-      bp = &tier->bin_mat[i];
-
-      copy_e_from_fft_2D(&(bp->e), bp->p);
-      copy_phi_from_fft_2D(&(bp->phi), bp->p);
+    // large cells gather their interior field through the SAT
+    if(isLargeUsed) {
+      bin_build_field_sat(tier);
+    }
+    else {
+      grid->is_sat_valid = false;
+    }
 
-      gsum_phi += bp->phi * bp->cell_area + bp->phi * bp->cell_area2 +
-                  bp->phi * bp->term_area + bp->phi * bp->virt_area;
-      // gsum_phi +=
-      //  bp->phi * (bp->den - target_cell_den);
+    for(int i = 0; i < grid->cnt; i++) {
+      gsum_phi += grid->phi[i] * (grid->cell_area[i] + grid->cell_area2[i] +
+                                  grid->fixed_area[i]);
 
-      ovf_cell_den = max((prec)0.0, bp->den2 - target_cell_den);
-      ovf_cell_area = ovf_cell_den * tier->bin_area;
-      sum_ovf_area += ovf_cell_area;
+      sum_ovf_area +=
+          max((prec)0.0, grid->den2[i] - target_cell_den) * tier->bin_area;
     }
     tier->sum_ovf = sum_ovf_area / tier->modu_area;
     gsum_ovf_area += sum_ovf_area;
@@ -923,54 +1038,51 @@ void bin_update7_mGP2D() {
 
 // 2D cGP2D
 void bin_update7_cGP2D() {
-  BIN *bp = NULL;
+  TIER *tier = &tier_st[0];
 
-  gsum_ovf_area = 0;
-  gsum_phi = 0;
+  // during the filler-only phase the std cells stay put, so their
+  // cell_area contribution is frozen after the first update and only
+  // the fillers are re-scattered into cell_area2.
+  bool isFillerOnly = (FILLER_PLACE == 1 && bin_base_frozen);
+  if(!isFillerOnly) {
+    bin_split_cells(tier);
+  }
 
-  TIER *tier = &tier_st[0];
+  bin_ctx.grid = tier->den_grid;
+  bin_ctx.eng = &dct_engine_2d;
+  BinUpdateCGP2D(&bin_ctx, tier, isFillerOnly);
+
+  bin_base_frozen = (FILLER_PLACE == 1);
+
+  tier->sum_ovf = bin_ctx.sum_ovf_area / tier->modu_area;
+  gsum_phi = bin_ctx.sum_phi;
+  gsum_ovf_area = bin_ctx.sum_ovf_area;
+  gsum_ovfl = gsum_ovf_area / total_modu_area;
+}
+
+// scatter, density and Poisson solve of ctx; the cell lists come from
+// the last bin_split_cells
+static void BinUpdateCGP2D(BIN_CTX *ctx, TIER *tier, bool isFillerOnly) {
+  DEN_GRID *grid = ctx->grid;
   bool timeon = false;
   double time = 0.0f;
 
-  omp_set_num_threads(numThread);
+  omp_set_num_threads(binThread);
   int i = 0;
 
   if(timeon) {
     time_start(&time);
   }
 
-#pragma omp parallel default(none) shared(tier) private(i)
-  {
-#pragma omp for
-    for(i = 0; i < tier->tot_bin_cnt; i++) {
-      BIN *bp = &tier->bin_mat[i];
-      bp->cell_area = 0;
-      bp->cell_area2 = 0;
-    }
-  }
-  if(timeon) {
-    time_end(&time);
-    cout << "initialize: " << time << endl;
-    time_start(&time);
-  }
+  // footprint slots for the overlap cache
+  BinOvlpBuild(ctx, tier, isFillerOnly);
 
   // update cell_area & cell_area2
-  //    omp_set_num_threads(1);
-
-  //    CELL* cellInst = tier->cell_st;
-  //    cout << tier->cell_cnt << endl;
-  //    exit(0);
-  //#pragma omp parallel \
-    default(none) \
-    shared(tier) \
-    private(i)
-  //    {
-
-  //#pragma omp for
-  for(i = 0; i < tier->cell_cnt; i++) {
-    den_comp_2d_cGP2D(tier->cell_st[i], tier);
+  if(!isFillerOnly) {
+    BinScatterCells(ctx, tier, bin_base_st, bin_base_cnt, grid->cell_area);
   }
-  //}
+  BinScatterCells(ctx, tier, bin_filler_st, bin_filler_cnt,
+                  grid->cell_area2);
 
   if(timeon) {
     time_end(&time);
@@ -978,20 +1090,14 @@ void bin_update7_cGP2D() {
     time_start(&time);
   }
 
-  omp_set_num_threads(numThread);
-#pragma omp parallel default(none) shared(tier) private(i)
+  // den is written straight into the FFT input plane
+#pragma omp parallel default(none) shared(tier, grid) private(i)
   {
 #pragma omp for
-    for(i = 0; i < tier->tot_bin_cnt; i++) {
-      BIN *bp = &tier->bin_mat[i];
-
-      prec area_num2 = bp->cell_area + bp->virt_area + bp->term_area;
-      prec area_num = area_num2 + bp->cell_area2;
-
-      bp->den = area_num * tier->inv_bin_area;
-      bp->den2 = area_num2 * tier->inv_bin_area;
-
-      copy_den_to_fft_2D(bp->den, bp->p);
+    for(i = 0; i < grid->cnt; i++) {
+      prec area_num2 = grid->cell_area[i] + grid->fixed_area[i];
+      grid->den[i] = (area_num2 + grid->cell_area2[i]) * tier->inv_bin_area;
+      grid->den2[i] = area_num2 * tier->inv_bin_area;
     }
   }
   if(timeon) {
@@ -1000,56 +1106,146 @@ void bin_update7_cGP2D() {
     time_start(&time);
   }
 
-  charge_fft_call(0);
+  charge_fft_solve_2d(ctx->eng, grid->den, grid->phi, grid->ex, grid->ey);
   if(timeon) {
     time_end(&time);
     cout << "charge_fft_call: " << time << endl;
     time_start(&time);
   }
 
-  prec sum_ovf_area = 0;
-  //#pragma omp parallel \
-    default(none) \
-    shared(tier, sum_ovf_area, gsum_phi, target_cell_den) \
-    private(i)
-  //    {
-  //        BIN *bp = NULL;
-  //#pragma omp for
-  for(i = 0; i < tier->tot_bin_cnt; i++) {
-    bp = &tier->bin_mat[i];
+  // phi / ex / ey stay in the FFT planes; no copy back to bin_mat
+  prec_acc sum_phi = 0;
+  prec_acc sum_ovf_area = 0;
+  for(i = 0; i < grid->cnt; i++) {
+    sum_phi += grid->phi[i] * (grid->cell_area[i] + grid->cell_area2[i] +
+                               grid->fixed_area[i]);
 
-    copy_e_from_fft_2D(&(bp->e), bp->p);
-    copy_phi_from_fft_2D(&(bp->phi), bp->p);
+    sum_ovf_area +=
+        max((prec)0.0, grid->den2[i] - target_cell_den) * tier->bin_area;
+  }
 
-    gsum_phi += bp->phi * bp->cell_area + bp->phi * bp->cell_area2 +
-                bp->phi * bp->term_area + bp->phi * bp->virt_area;
+  if(timeon) {
+    time_end(&time);
+    cout << "bin final loop: " << time << endl;
+  }
 
-    //        cout << i << " " << gsum_phi << endl;
+  ctx->sum_phi = sum_phi;
+  ctx->sum_ovf_area = sum_ovf_area;
+}
 
-    // gsum_phi +=
-    //  bp->phi * (bp->den - target_cell_den);
+// allocate tier's SoA planes; called once bin_mat is filled
+//
+void den_grid_init(TIER *tier) {
+  DEN_GRID *grid = (DEN_GRID *)malloc(sizeof(DEN_GRID));
+  grid->cnt = tier->tot_bin_cnt;
+
+  grid->cell_area = AllocAlignedPrec(grid->cnt);
+  grid->cell_area2 = AllocAlignedPrec(grid->cnt);
+  grid->fixed_area = AllocAlignedPrec(grid->cnt);
+  grid->den2 = AllocAlignedPrec(grid->cnt);
+  grid->diff_area = AllocAlignedPrec(grid->cnt);
+  grid->is_diff_used = false;
+
+  size_t satCnt = (size_t)(tier->dim_bin.x + 1) * (tier->dim_bin.y + 1);
+  grid->sat_ex = (double *)calloc(satCnt, sizeof(double));
+  grid->sat_ey = (double *)calloc(satCnt, sizeof(double));
+  grid->is_sat_valid = false;
+
+  for(int i = 0; i < grid->cnt; i++) {
+    BIN *bp = &tier->bin_mat[i];
+    grid->cell_area[i] = grid->cell_area2[i] = 0;
+    grid->diff_area[i] = 0;
+    grid->fixed_area[i] = bp->virt_area + bp->term_area;
+    grid->den2[i] = 0;
+  }
 
-    //        prec ovf_cell_den = max((prec)0.0, bp->den2 - target_cell_den);
-    //        prec ovf_cell_area = ovf_cell_den * tier->bin_area;
-    //        sum_ovf_area += ovf_cell_area;
+  grid->den = grid->phi = grid->ex = grid->ey = NULL;
+  tier->den_grid = grid;
+}
 
-    sum_ovf_area += max((prec)0.0, bp->den2 - target_cell_den) * tier->bin_area;
+void den_grid_delete(TIER *tier) {
+  DEN_GRID *grid = tier->den_grid;
+  if(!grid) {
+    return;
   }
+  free(grid->cell_area);
+  free(grid->cell_area2);
+  free(grid->fixed_area);
+  free(grid->den2);
+  free(grid->diff_area);
+  free(grid->sat_ex);
+  free(grid->sat_ey);
+  free(grid);
+  tier->den_grid = NULL;
+}
 
-  if(timeon) {
-    time_end(&time);
-    cout << "bin final loop: " << time << endl;
+// summed-area tables of the field, in double to keep the
+// differences of large partial sums accurate
+//
+void bin_build_field_sat(TIER *tier) {
+  DEN_GRID *grid = tier->den_grid;
+  int dimX = tier->dim_bin.x, dimY = tier->dim_bin.y;
+  int satY = dimY + 1;
+
+  for(int x = 0; x < dimX; x++) {
+    double rowEx = 0, rowEy = 0;
+    for(int y = 0; y < dimY; y++) {
+      rowEx += grid->ex[x * dimY + y];
+      rowEy += grid->ey[x * dimY + y];
+      grid->sat_ex[(x + 1) * satY + y + 1] = grid->sat_ex[x * satY + y + 1] + rowEx;
+      grid->sat_ey[(x + 1) * satY + y + 1] = grid->sat_ey[x * satY + y + 1] + rowEy;
+    }
   }
+  grid->is_sat_valid = true;
+}
 
-  // cout << "sum_ovf_area: " << sum_ovf_area << endl;
+// sum of (ex, ey) over bins [i0, i1]
+//
+FPOS GetFieldSumSAT(TIER *tier, POS i0, POS i1) {
+  DEN_GRID *grid = tier->den_grid;
+  int satY = tier->dim_bin.y + 1;
+  int a = i0.x * satY + i0.y;
+  int b = i0.x * satY + i1.y + 1;
+  int c = (i1.x + 1) * satY + i0.y;
+  int d = (i1.x + 1) * satY + i1.y + 1;
+
+  FPOS sum;
+  sum.x = grid->sat_ex[d] - grid->sat_ex[b] - grid->sat_ex[c] + grid->sat_ex[a];
+  sum.y = grid->sat_ey[d] - grid->sat_ey[b] - grid->sat_ey[c] + grid->sat_ey[a];
+  return sum;
+}
 
-  tier->sum_ovf = sum_ovf_area / tier->modu_area;
-  gsum_ovf_area += sum_ovf_area;
-  // cout << "gsum_ovf_area: " << gsum_ovf_area << endl;
-  // cout << "total_modu_area: " << total_modu_area << endl;
+// bind den/phi/ex/ey to the FFT planes.
+// must follow charge_fft_init (dft_bin_2d == tier->dim_bin)
+//
+void bin_attach_fft_2D(void) {
+  for(int z = 0; z < numLayer; z++) {
+    DEN_GRID *grid = tier_st[z].den_grid;
+    grid->den = den_2d_plane;
+    grid->phi = phi_2d_plane;
+    grid->ex = ex_2d_plane;
+    grid->ey = ey_2d_plane;
+  }
+}
 
-  gsum_ovfl = gsum_ovf_area / total_modu_area;
-  // cout << "gsumovfl: " << gsum_ovfl << endl;
+// refresh BIN's per-iteration fields from the grid (plots, debugging)
+//
+void bin_update_mat_from_grid(TIER *tier) {
+  DEN_GRID *grid = tier->den_grid;
+  if(!grid || !grid->phi) {
+    return;
+  }
+  for(int i = 0; i < grid->cnt; i++) {
+    BIN *bp = &tier->bin_mat[i];
+    bp->cell_area = grid->cell_area[i];
+    bp->cell_area2 = grid->cell_area2[i];
+    bp->den = (grid->cell_area[i] + grid->cell_area2[i] +
+               grid->fixed_area[i]) * tier->inv_bin_area;
+    bp->den2 = grid->den2[i];
+    bp->phi = grid->phi[i];
+    bp->e.x = grid->ex[i];
+    bp->e.y = grid->ey[i];
+  }
 }
 
 void get_term_den(prec *den) {
@@ -1458,6 +1654,7 @@ void den_comp_2d_mGP2D(CELL *cell, TIER *tier) {
   prec min_x = 0, min_y = 0;
   prec max_x = 0, max_y = 0;
   BIN *bpx = NULL, *bpy = NULL /* ,*bpz=NULL */;
+  DEN_GRID *grid = tier->den_grid;
 
   POS b0, b1;
 
@@ -1485,10 +1682,41 @@ void den_comp_2d_mGP2D(CELL *cell, TIER *tier) {
   if(b1.y > tier->dim_bin.y - 1)
     b1.y = tier->dim_bin.y - 1;
 
-  idx = b0.x * tier->dim_bin.y + b0.y;
+  prec *dest = (cell->flg == FillerCell) ? grid->cell_area2 : grid->cell_area;
+  prec macroScale = (cell->flg == Macro) ? global_macro_area_scale : 1.0;
+
+  // large objects: bins fully covered by the cell go through the
+  // difference array (O(1) per cell); only the boundary ring below
+  // is computed exactly.
+  POS i0, i1;
+  bool isLarge = false;
+  if(cell->flg != FillerCell) {
+    isLarge = GetCoveredBinRange(cell, tier, b0, b1, &i0, &i1) &&
+              (i1.x - i0.x + 1) * (i1.y - i0.y + 1) >= DEN_DIFF_MIN_BINS;
+  }
+
+  if(isLarge) {
+    prec val = tier->bin_area * cell->den_scal * macroScale;
+    int dimY = tier->dim_bin.y;
+    bool isEndX = (i1.x + 1 < tier->dim_bin.x);
+    bool isEndY = (i1.y + 1 < dimY);
 
-  for(x = b0.x, bpx = &tier->bin_mat[idx]; x <= b1.x;
-      x++, bpx += tier->dim_bin.y) {
+    grid->diff_area[i0.x * dimY + i0.y] += val;
+    if(isEndY) {
+      grid->diff_area[i0.x * dimY + i1.y + 1] -= val;
+    }
+    if(isEndX) {
+      grid->diff_area[(i1.x + 1) * dimY + i0.y] -= val;
+    }
+    if(isEndX && isEndY) {
+      grid->diff_area[(i1.x + 1) * dimY + i1.y + 1] += val;
+    }
+    grid->is_diff_used = true;
+  }
+
+  for(x = b0.x; x <= b1.x; x++) {
+    idx = x * tier->dim_bin.y + b0.y;
+    bpx = &tier->bin_mat[idx];
     max_x = min(bpx->pmax.x, cell->den_pmax.x);
     min_x = max(bpx->pmin.x, cell->den_pmin.x);
 
@@ -1498,7 +1726,17 @@ void den_comp_2d_mGP2D(CELL *cell, TIER *tier) {
       continue;
     }
 
-    for(y = b0.y, bpy = bpx; y <= b1.y; y++, bpy++) {
+    bool isInnerCol = isLarge && i0.x <= x && x <= i1.x;
+
+    for(y = b0.y; y <= b1.y; y++, idx++) {
+      // jump over the covered part of this column
+      if(isInnerCol && y == i0.y) {
+        idx += i1.y - y;
+        y = i1.y;
+        continue;
+      }
+
+      bpy = &tier->bin_mat[idx];
       max_y = min(bpy->pmax.y, cell->den_pmax.y);
       min_y = max(bpy->pmin.y, cell->den_pmin.y);
 
@@ -1511,86 +1749,440 @@ void den_comp_2d_mGP2D(CELL *cell, TIER *tier) {
       area_share =
           (max_x - min_x) * (max_y - min_y) * cell->den_scal;
 
-      if(cell->flg == FillerCell) {
-        bpy->cell_area2 += area_share;
-      }
-      else if(cell->flg == Macro) {
-        bpy->cell_area += area_share * global_macro_area_scale;
-      }
-      else {
-        bpy->cell_area += area_share;
-      }
+      dest[idx] += area_share * macroScale;
     }
   }
 }
 
+// bins in [b0, b1] lying completely inside cell's density rectangle.
+// returns false if there are none.
+//
+bool GetCoveredBinRange(FPOS pmin, FPOS pmax, TIER *tier, POS b0, POS b1,
+                        POS *i0, POS *i1) {
+  int dimY = tier->dim_bin.y;
+  BIN *bm = tier->bin_mat;
+
+  i0->x = b0.x;
+  while(i0->x <= b1.x && bm[i0->x * dimY].pmin.x < pmin.x) {
+    i0->x++;
+  }
+  i1->x = b1.x;
+  while(i1->x >= i0->x && bm[i1->x * dimY].pmax.x > pmax.x) {
+    i1->x--;
+  }
+  i0->y = b0.y;
+  while(i0->y <= b1.y && bm[i0->y].pmin.y < pmin.y) {
+    i0->y++;
+  }
+  i1->y = b1.y;
+  while(i1->y >= i0->y && bm[i1->y].pmax.y > pmax.y) {
+    i1->y--;
+  }
+  return i0->x <= i1->x && i0->y <= i1->y;
+}
+
+// resolve the difference array into cell_area: 2D prefix sum, then clear
+//
+static void ApplyDiffArea(TIER *tier) {
+  DEN_GRID *grid = tier->den_grid;
+  int dimX = tier->dim_bin.x, dimY = tier->dim_bin.y;
+  prec *diff = grid->diff_area;
+
+  for(int x = 0; x < dimX; x++) {
+    for(int y = 1; y < dimY; y++) {
+      diff[x * dimY + y] += diff[x * dimY + y - 1];
+    }
+  }
+  for(int x = 1; x < dimX; x++) {
+    for(int y = 0; y < dimY; y++) {
+      diff[x * dimY + y] += diff[(x - 1) * dimY + y];
+    }
+  }
+  for(int i = 0; i < grid->cnt; i++) {
+    grid->cell_area[i] += diff[i];
+    diff[i] = 0;
+  }
+  grid->is_diff_used = false;
+}
+
 // calculate
 //
-// tier->bin_mat->cell_area (Normal & Macro) and
-// tier->bin_mat->cell_area2(Filler Cell)
+// tier->den_grid->cell_area (Normal & Macro) and
+// tier->den_grid->cell_area2(Filler Cell)
 //
 void den_comp_2d_cGP2D(CELL *cell, TIER *tier) {
-  POS b0, b1;
-  b0.x = INT_DOWN((cell->den_pmin.x - tier->bin_org.x) * tier->inv_bin_stp.x);
-  b0.y = INT_DOWN((cell->den_pmin.y - tier->bin_org.y) * tier->inv_bin_stp.y);
+  den_comp_2d_cGP2D_plane(cell, tier, tier->den_grid->cell_area,
+                          tier->den_grid->cell_area2);
+}
 
-  b1.x = INT_DOWN((cell->den_pmax.x - tier->bin_org.x) * tier->inv_bin_stp.x);
-  b1.y = INT_DOWN((cell->den_pmax.y - tier->bin_org.y) * tier->inv_bin_stp.y);
+// accumulate cell's area share into the given cell_area / cell_area2
+// planes (indexed as bin_mat); the planes may be thread-private.
+//
+// if ovlpBin/ovlpShare are given, the (bin index, area share) pairs are
+// also recorded there in scan order.
+//
+void den_comp_2d_cGP2D_plane(CELL *cell, TIER *tier, prec *cellArea,
+                             prec *cellArea2, int *ovlpBin,
+                             prec *ovlpShare) {
+  DenComp2D(cell, tier, cell->den_pmin, cell->den_pmax, cellArea, cellArea2,
+            ovlpBin, ovlpShare);
+}
 
-  if(b0.x < 0)
-    b0.x = 0;
-  if(b0.x > tier->dim_bin.x - 1)
-    b0.x = tier->dim_bin.x - 1;
-  if(b0.y < 0)
-    b0.y = 0;
-  if(b0.y > tier->dim_bin.y - 1)
-    b0.y = tier->dim_bin.y - 1;
+// den_comp_2d_cGP2D_plane with the density box [pmin, pmax]
+static void DenComp2D(CELL *cell, TIER *tier, FPOS pmin, FPOS pmax,
+                      prec *cellArea, prec *cellArea2, int *ovlpBin,
+                      prec *ovlpShare) {
+  POS b0, b1;
+  GetDenBinRange(pmin, pmax, tier, &b0, &b1);
 
-  if(b1.x < 0)
-    b1.x = 0;
-  if(b1.x > tier->dim_bin.x - 1)
-    b1.x = tier->dim_bin.x - 1;
-  if(b1.y < 0)
-    b1.y = 0;
-  if(b1.y > tier->dim_bin.y - 1)
-    b1.y = tier->dim_bin.y - 1;
+  prec *dest = (cell->flg == FillerCell) ? cellArea2 : cellArea;
+  prec macroScale = (cell->flg == Macro) ? global_macro_area_scale : 1.0;
 
-  int idx = b0.x * tier->dim_bin.y + b0.y;
+  for(int x = b0.x; x <= b1.x; x++) {
+    int idx = x * tier->dim_bin.y + b0.y;
+    BIN *bpx = &tier->bin_mat[idx];
+    prec max_x = min(bpx->pmax.x, pmax.x);
+    prec min_x = max(bpx->pmin.x, pmin.x);
+
+    for(int y = b0.y; y <= b1.y; y++, idx++) {
+      BIN *bpy = &tier->bin_mat[idx];
+      prec max_y = min(bpy->pmax.y, pmax.y);
+      prec min_y = max(bpy->pmin.y, pmin.y);
 
-  int x = 0, y = 0;
-  BIN *bpx = NULL, *bpy = NULL;
-  for(x = b0.x, bpx = &tier->bin_mat[idx]; x <= b1.x;
-      x++, bpx += tier->dim_bin.y) {
-    prec max_x = min(bpx->pmax.x, cell->den_pmax.x);
-    prec min_x = max(bpx->pmin.x, cell->den_pmin.x);
-
-    for(y = b0.y, bpy = bpx; y <= b1.y; y++, bpy++) {
-      prec max_y = min(bpy->pmax.y, cell->den_pmax.y);
-      prec min_y = max(bpy->pmin.y, cell->den_pmin.y);
-
-      //            if( fabs(cell->size.z - 1.0f) > 1E-5 ) {
-      //                cout << cell->size.z << endl;
-      //                exit(1);
-      //            }
-      //            prec area_share = (max_x - min_x) * (max_y - min_y) *
-      //            cell->size.z *
-      //                         cell->den_scal;
       prec area_share = (max_x - min_x) * (max_y - min_y) * cell->den_scal;
+      dest[idx] += area_share * macroScale;
 
-      if(cell->flg == FillerCell) {
-        bpy->cell_area2 += area_share;
+      if(ovlpBin) {
+        *ovlpBin++ = idx;
+        *ovlpShare++ = area_share;
       }
-      // mod LW 10/29/16 ev609
-      else if(cell->flg == Macro) {
-        bpy->cell_area += area_share * global_macro_area_scale;
+    }
+  }
+}
+
+// count and key the footprints of cells[0, cnt), laying them out
+// contiguously from offset 'total'. returns the end offset.
+//
+static size_t bin_ovlp_layout(BIN_CTX *ctx, TIER *tier, CELL **cells,
+                              int cnt, size_t total) {
+  BIN_OVLP *ovlp = &ctx->ovlp;
+  int i = 0;
+#pragma omp parallel for default(none) \
+    shared(ctx, ovlp, tier, cells, cnt, gcell_st) private(i)
+  for(i = 0; i < cnt; i++) {
+    CELL *cell = cells[i];
+    int cellIdx = cell - gcell_st;
+    FPOS pmin, pmax;
+    GetDenBox(ctx, cell, &pmin, &pmax);
+    POS b0, b1;
+    GetDenBinRange(pmin, pmax, tier, &b0, &b1);
+    ovlp->cnt[cellIdx] = (b1.x - b0.x + 1) * (b1.y - b0.y + 1);
+    ovlp->key[2 * cellIdx] = pmin;
+    ovlp->key[2 * cellIdx + 1] = pmax;
+  }
+
+  for(i = 0; i < cnt; i++) {
+    int cellIdx = cells[i] - gcell_st;
+    ovlp->start[cellIdx] = total;
+    total += ovlp->cnt[cellIdx];
+  }
+  return total;
+}
+
+void bin_ovlp_build(TIER *tier, bool isFillerOnly) {
+  BinOvlpBuild(&bin_ctx, tier, isFillerOnly);
+}
+
+// size the overlap cache for the current cell positions.
+// base (non-filler) footprints come first, so a filler-only update
+// re-lays out just the filler part behind them.
+//
+static void BinOvlpBuild(BIN_CTX *ctx, TIER *tier, bool isFillerOnly) {
+  BIN_OVLP *ovlp = &ctx->ovlp;
+  bool isFresh = false;
+  if(ovlp->cell_cap < gcell_cnt) {
+    free(ovlp->start);
+    free(ovlp->cnt);
+    free(ovlp->key);
+    ovlp->start = (int *)malloc(sizeof(int) * gcell_cnt);
+    ovlp->cnt = (int *)malloc(sizeof(int) * gcell_cnt);
+    ovlp->key = (FPOS *)malloc(sizeof(FPOS) * 2 * gcell_cnt);
+    ovlp->cell_cap = gcell_cnt;
+    ovlp->base_total = 0;
+    isFresh = true;
+  }
+
+  if(!isFillerOnly || isFresh) {
+    // cells outside cell_st (e.g. fixed macros) never hit the cache
+    for(int i = 0; i < gcell_cnt; i++) {
+      ovlp->cnt[i] = 0;
+      ovlp->key[2 * i].x = PREC_MAX;
+    }
+  }
+  if(!isFillerOnly) {
+    ovlp->base_total =
+        bin_ovlp_layout(ctx, tier, bin_base_st, bin_base_cnt, 0);
+  }
+  size_t total = bin_ovlp_layout(ctx, tier, bin_filler_st, bin_filler_cnt,
+                                 ovlp->base_total);
+
+  if(ovlp->cap < total) {
+    // realloc keeps the frozen base footprints
+    ovlp->cap = total + total / 4;
+    ovlp->bin = (int *)realloc(ovlp->bin, sizeof(int) * ovlp->cap);
+    ovlp->share = (prec *)realloc(ovlp->share, sizeof(prec) * ovlp->cap);
+  }
+  ovlp->is_valid = true;
+}
+
+// footprint of gcell_st[cellIdx] from the last scatter.
+// returns the entry count, or -1 if the cell has moved since.
+//
+int bin_ovlp_get(int cellIdx, int **bins, prec **shares) {
+  CELL *cell = &gcell_st[cellIdx];
+  return bin_ovlp_get_ctx(&bin_ctx, cellIdx, cell->den_pmin, cell->den_pmax,
+                          bins, shares);
+}
+
+// same for ctx's last scatter, with the cell's density box [pmin, pmax]
+int bin_ovlp_get_ctx(BIN_CTX *ctx, int cellIdx, FPOS pmin, FPOS pmax,
+                     int **bins, prec **shares) {
+  BIN_OVLP *ovlp = &ctx->ovlp;
+  if(!ovlp->is_valid || cellIdx >= ovlp->cell_cap) {
+    return -1;
+  }
+  FPOS *key = &ovlp->key[2 * cellIdx];
+  if(key[0].x != pmin.x || key[0].y != pmin.y || key[1].x != pmax.x ||
+     key[1].y != pmax.y) {
+    return -1;
+  }
+  *bins = &ovlp->bin[ovlp->start[cellIdx]];
+  *shares = &ovlp->share[ovlp->start[cellIdx]];
+  return ovlp->cnt[cellIdx];
+}
+
+static void BinOvlpDelete(BIN_OVLP *ovlp) {
+  free(ovlp->start);
+  free(ovlp->cnt);
+  free(ovlp->key);
+  free(ovlp->bin);
+  free(ovlp->share);
+  ovlp->start = ovlp->cnt = ovlp->bin = NULL;
+  ovlp->key = NULL;
+  ovlp->share = NULL;
+  ovlp->cell_cap = 0;
+  ovlp->cap = 0;
+  ovlp->base_total = 0;
+  ovlp->is_valid = false;
+}
+
+void bin_ovlp_delete(void) {
+  BinOvlpDelete(&bin_ctx.ovlp);
+}
+
+// split tier->cell_st into base (std cell / macro) and filler lists
+//
+void bin_split_cells(TIER *tier) {
+  if(bin_cell_cap < tier->cell_cnt) {
+    free(bin_base_st);
+    free(bin_filler_st);
+    bin_base_st = (CELL **)malloc(sizeof(CELL *) * tier->cell_cnt);
+    bin_filler_st = (CELL **)malloc(sizeof(CELL *) * tier->cell_cnt);
+    bin_cell_cap = tier->cell_cnt;
+  }
+  bin_base_cnt = bin_filler_cnt = 0;
+  for(int i = 0; i < tier->cell_cnt; i++) {
+    CELL *cell = tier->cell_st[i];
+    if(cell->flg == FillerCell) {
+      bin_filler_st[bin_filler_cnt++] = cell;
+    }
+    else {
+      bin_base_st[bin_base_cnt++] = cell;
+    }
+  }
+}
+
+void bin_scatter_cells(TIER *tier, CELL **cells, int cnt, prec *dest) {
+  BinScatterCells(&bin_ctx, tier, cells, cnt, dest);
+}
+
+// clear dest and scatter cells[0, cnt) into it, recording footprints.
+//
+// with -t > 1, threads would race on dest, so the cells are cut into
+// contiguous parts, each scattered into a private plane; the planes are
+// summed per bin in part order afterwards. There is one part per thread,
+// or BIN_DET_SCATTER_PARTS with -det so the sums do not depend on -t.
+//
+static void BinScatterCells(BIN_CTX *ctx, TIER *tier, CELL **cells, int cnt,
+                            prec *dest) {
+  BIN_OVLP *ovlp = &ctx->ovlp;
+  int binCnt = tier->tot_bin_cnt;
+  int partCnt = isDeterministic ? BIN_DET_SCATTER_PARTS : binThread;
+  int i = 0;
+
+  if(partCnt == 1) {
+    memset(dest, 0, sizeof(prec) * binCnt);
+    for(i = 0; i < cnt; i++) {
+      FPOS pmin, pmax;
+      GetDenBox(ctx, cells[i], &pmin, &pmax);
+      int start = ovlp->start[cells[i] - gcell_st];
+      DenComp2D(cells[i], tier, pmin, pmax, dest, dest, &ovlp->bin[start],
+                &ovlp->share[start]);
+    }
+    return;
+  }
+
+  BinPrivInit(ctx, tier, partCnt);
+  prec *privArea = ctx->priv_area;
+
+  omp_set_num_threads(binThread);
+#pragma omp parallel default(none) \
+    shared(ctx, ovlp, tier, cells, cnt, dest, binCnt, partCnt, privArea, \
+           gcell_st) private(i)
+  {
+#pragma omp for schedule(static, 1)
+    for(i = 0; i < partCnt; i++) {
+      prec *area = &privArea[(size_t)i * binCnt];
+      memset(area, 0, sizeof(prec) * binCnt);
+
+      int c1 = (int)((long)cnt * (i + 1) / partCnt);
+      for(int c = (int)((long)cnt * i / partCnt); c < c1; c++) {
+        FPOS pmin, pmax;
+        GetDenBox(ctx, cells[c], &pmin, &pmax);
+        int start = ovlp->start[cells[c] - gcell_st];
+        DenComp2D(cells[c], tier, pmin, pmax, area, area, &ovlp->bin[start],
+                  &ovlp->share[start]);
       }
-      else {
-        bpy->cell_area += area_share;
+    }
+
+#pragma omp for schedule(static)
+    for(i = 0; i < binCnt; i++) {
+      prec sum = 0;
+      for(int t = 0; t < partCnt; t++) {
+        sum += privArea[(size_t)t * binCnt + i];
       }
+      dest[i] = sum;
     }
   }
+}
 
-  return;
+void bin_priv_init(TIER *tier, int planeCnt) {
+  BinPrivInit(&bin_ctx, tier, planeCnt);
+}
+
+// (re)allocate planeCnt private area planes for tier's bin grid
+//
+static void BinPrivInit(BIN_CTX *ctx, TIER *tier, int planeCnt) {
+  size_t cnt = (size_t)planeCnt * tier->tot_bin_cnt;
+  if(cnt == ctx->priv_cnt) {
+    return;
+  }
+  free(ctx->priv_area);
+  ctx->priv_area = (prec *)malloc(sizeof(prec) * cnt);
+  ctx->priv_cnt = cnt;
+}
+
+void bin_priv_delete(void) {
+  free(bin_ctx.priv_area);
+  bin_ctx.priv_area = NULL;
+  bin_ctx.priv_cnt = 0;
+}
+
+// a private context for tier 0's grid: own area / density / FFT planes,
+// overlap cache and a DCT engine of threadCnt threads; fixed_area is
+// shared read-only with the tier's grid
+//
+void bin_ctx_init(BIN_CTX *ctx, int threadCnt) {
+  TIER *tier = &tier_st[0];
+  DEN_GRID *grid = (DEN_GRID *)malloc(sizeof(DEN_GRID));
+  *grid = *tier->den_grid;
+
+  grid->cell_area = AllocAlignedPrec(grid->cnt);
+  grid->cell_area2 = AllocAlignedPrec(grid->cnt);
+  grid->den2 = AllocAlignedPrec(grid->cnt);
+  grid->den = AllocAlignedPrec(grid->cnt);
+  grid->phi = AllocAlignedPrec(grid->cnt);
+  grid->ex = AllocAlignedPrec(grid->cnt);
+  grid->ey = AllocAlignedPrec(grid->cnt);
+  grid->diff_area = NULL;
+  grid->is_diff_used = false;
+  grid->sat_ex = grid->sat_ey = NULL;
+  grid->is_sat_valid = false;
+
+  *ctx = BIN_CTX();
+  ctx->grid = grid;
+  ctx->eng = (DCT2D_ENGINE *)malloc(sizeof(DCT2D_ENGINE));
+  dct2d_engine_init(ctx->eng, dft_bin_2d.x, dft_bin_2d.y, threadCnt);
+  ctx->den_box = (FPOS *)malloc(sizeof(FPOS) * 2 * gcell_cnt);
+}
+
+void bin_ctx_delete(BIN_CTX *ctx) {
+  DEN_GRID *grid = ctx->grid;
+  free(grid->cell_area);
+  free(grid->cell_area2);
+  free(grid->den2);
+  free(grid->den);
+  free(grid->phi);
+  free(grid->ex);
+  free(grid->ey);
+  free(grid);
+
+  dct2d_engine_delete(ctx->eng);
+  free(ctx->eng);
+  BinOvlpDelete(&ctx->ovlp);
+  free(ctx->den_box);
+  free(ctx->priv_area);
+  *ctx = BIN_CTX();
+}
+
+// density of tier 0 with the gcells at st, into ctx only. The boxes use
+// net_update_cells' arithmetic, so the footprints stay valid once the
+// cells are moved to st (bin_ctx_adopt). Needs a full bin_split_cells.
+//
+void bin_update_ctx(BIN_CTX *ctx, FPOS *st) {
+  FPOS *box = ctx->den_box;
+  int i = 0;
+
+  omp_set_num_threads(binThread);
+#pragma omp parallel for default(none) shared(gcell_cnt, gcell_st, st, box) \
+    private(i)
+  for(i = 0; i < gcell_cnt; i++) {
+    FPOS half = gcell_st[i].half_den_size;
+    box[2 * i].x = st[i].x - half.x;
+    box[2 * i].y = st[i].y - half.y;
+    box[2 * i + 1].x = st[i].x + half.x;
+    box[2 * i + 1].y = st[i].y + half.y;
+  }
+
+  BinUpdateCGP2D(ctx, &tier_st[0], false);
+}
+
+// make ctx's last bin_update_ctx the tier's bin_update: the planes are
+// copied to the tier's grid and the overlap caches exchanged. The cells
+// must have been moved to that update's st.
+//
+void bin_ctx_adopt(BIN_CTX *ctx) {
+  TIER *tier = &tier_st[0];
+  DEN_GRID *grid = tier->den_grid;
+  DEN_GRID *src = ctx->grid;
+  size_t planeSize = sizeof(prec) * grid->cnt;
+
+  memcpy(grid->cell_area, src->cell_area, planeSize);
+  memcpy(grid->cell_area2, src->cell_area2, planeSize);
+  memcpy(grid->den2, src->den2, planeSize);
+  memcpy(grid->den, src->den, planeSize);
+  memcpy(grid->phi, src->phi, planeSize);
+  memcpy(grid->ex, src->ex, planeSize);
+  memcpy(grid->ey, src->ey, planeSize);
+  grid->is_sat_valid = false;
+
+  std::swap(bin_ctx.ovlp, ctx->ovlp);
+  bin_base_frozen = false;
+
+  tier->sum_ovf = ctx->sum_ovf_area / tier->modu_area;
+  gsum_phi = ctx->sum_phi;
+  gsum_ovf_area = ctx->sum_ovf_area;
+  gsum_ovfl = gsum_ovf_area / total_modu_area;
 }
 
 void bin_delete_mGP2D(void) {
@@ -1599,6 +2191,7 @@ void bin_delete_mGP2D(void) {
     tier->bin_mat = NULL;
     tier->tot_bin_cnt = 0;
     // free (bin_mat_st[currTier]);
+    den_grid_delete(tier);
   }
   free(bin_mat_st);
   bin_mat_st = NULL;
@@ -98,6 +98,66 @@ struct BIN {
   }
 };
 
+// structure-of-arrays copy of the per-iteration BIN fields.
+//
+// Every plane is indexed like bin_mat (x * dim_bin.y + y).
+// den / phi / ex / ey are the FFT planes themselves (fft.h),
+// so the Poisson solve reads and writes them in place.
+//
+// BIN::cell_area, den, phi, e, ... are NOT updated during GP;
+// call bin_update_mat_from_grid() before reading them.
+struct DEN_GRID {
+  int cnt;
+  prec *cell_area;   // std cells & macros
+  prec *cell_area2;  // filler cells
+  prec *fixed_area;  // virt_area + term_area
+  prec *den2;        // density without fillers
+  prec *diff_area;   // 2D difference array for large cells (mGP2D)
+  bool is_diff_used;
+
+  // summed-area tables of ex / ey, (dim_bin.x + 1) * (dim_bin.y + 1)
+  // with a zero first row/column; valid only after large cells were seen
+  double *sat_ex;
+  double *sat_ey;
+  bool is_sat_valid;
+
+  prec *den;  // FFT input; spectral coefficients after charge_fft_call
+  prec *phi;
+  prec *ex;
+  prec *ey;
+};
+
+// cell -> bin overlap cache, filled by the cGP2D scatter and read back by
+// potn_grad_2D. indexed by gcell index; entries live in
+// bin/share[start[i], start[i] + cnt[i]). key holds the density box each
+// footprint was built for.
+struct BIN_OVLP {
+  int *start;
+  int *cnt;
+  FPOS *key;
+  int *bin;
+  prec *share;
+  int cell_cap;
+  size_t cap;
+  size_t base_total;
+  bool is_valid;
+};
+
+// one cGP2D density evaluation: grid planes, Poisson engine, overlap
+// cache and scatter planes. bin_update7_cGP2D runs on the tier's own
+// context; a -specStep candidate (ns.cpp) gets a private one from
+// bin_ctx_init and is evaluated at its positions without moving the cells.
+struct BIN_CTX {
+  DEN_GRID *grid;
+  struct DCT2D_ENGINE *eng;
+  BIN_OVLP ovlp;
+  FPOS *den_box;  // den_pmin / den_pmax per gcell; NULL: the cells' own
+  prec *priv_area;
+  size_t priv_cnt;
+  prec_acc sum_phi;
+  prec_acc sum_ovf_area;
+};
+
 int idx_in_bin_rect(POS *p, POS pmin, POS pmax);
 
 void bin_init();
@@ -109,6 +169,20 @@ void bin_update();
 void bin_update7_cGP2D();
 void bin_update7_mGP2D();
 
+void den_grid_init(TIER *tier);
+void bin_build_field_sat(TIER *tier);
+FPOS GetFieldSumSAT(TIER *tier, POS i0, POS i1);
+bool GetCoveredBinRange(FPOS pmin, FPOS pmax, TIER *tier, POS b0, POS b1,
+                        POS *i0, POS *i1);
+inline bool GetCoveredBinRange(CELL *cell, TIER *tier, POS b0, POS b1,
+                               POS *i0, POS *i1) {
+  return GetCoveredBinRange(cell->den_pmin, cell->den_pmax, tier, b0, b1, i0,
+                            i1);
+}
+void den_grid_delete(TIER *tier);
+void bin_attach_fft_2D(void);
+void bin_update_mat_from_grid(TIER *tier);
+
 void bin_delete(void);
 
 void get_bin_grad(BIN **bin, int max_x, int max_y);
@@ -159,6 +233,53 @@ GetCoordiLayoutInside(FPOS center_coordi, FPOS half_size) {
   return v1;
 }
 
+// bin index range [b0, b1] overlapped by cell's density rectangle.
+// shared by the density scatter and the potential gather.
+//
+inline void GetDenBinRange(FPOS pmin, FPOS pmax, TIER *tier, POS *b0,
+                           POS *b1) {
+  b0->x = INT_DOWN((pmin.x - tier->bin_org.x) * tier->inv_bin_stp.x);
+  b0->y = INT_DOWN((pmin.y - tier->bin_org.y) * tier->inv_bin_stp.y);
+
+  b1->x = INT_DOWN((pmax.x - tier->bin_org.x) * tier->inv_bin_stp.x);
+  b1->y = INT_DOWN((pmax.y - tier->bin_org.y) * tier->inv_bin_stp.y);
+
+  if(b0->x < 0)
+    b0->x = 0;
+  if(b0->x > tier->dim_bin.x - 1)
+    b0->x = tier->dim_bin.x - 1;
+  if(b0->y < 0)
+    b0->y = 0;
+  if(b0->y > tier->dim_bin.y - 1)
+    b0->y = tier->dim_bin.y - 1;
+
+  if(b1->x < 0)
+    b1->x = 0;
+  if(b1->x > tier->dim_bin.x - 1)
+    b1->x = tier->dim_bin.x - 1;
+  if(b1->y < 0)
+    b1->y = 0;
+  if(b1->y > tier->dim_bin.y - 1)
+    b1->y = tier->dim_bin.y - 1;
+}
+
+inline void GetDenBinRange(CELL *cell, TIER *tier, POS *b0, POS *b1) {
+  GetDenBinRange(cell->den_pmin, cell->den_pmax, tier, b0, b1);
+}
+
+// cell's density box as seen by ctx
+inline void GetDenBox(BIN_CTX *ctx, CELL *cell, FPOS *pmin, FPOS *pmax) {
+  if(ctx->den_box) {
+    int cellIdx = cell - gcell_st;
+    *pmin = ctx->den_box[2 * cellIdx];
+    *pmax = ctx->den_box[2 * cellIdx + 1];
+  }
+  else {
+    *pmin = cell->den_pmin;
+    *pmax = cell->den_pmax;
+  }
+}
+
 int is_IO_block(TERM *term);
 
 void get_bins(FPOS center, CELL *cell, POS *st, prec *share_st, int *bin_cnt);
@@ -166,6 +287,15 @@ void get_bins(FPOS center, CELL *cell, POS *st, prec *share_st, int *bin_cnt);
 void fft_test(void);
 
 #define DEN_SMOOTH_COF 5.0
+// min. fully-covered bins for den_comp_2d_mGP2D's difference-array path
+#define DEN_DIFF_MIN_BINS 16
+// -binAuto: accepted bin-count window relative to the ideal count,
+// and the largest bin aspect ratio
+#define BIN_AUTO_MIN_FILL 0.8
+#define BIN_AUTO_MAX_ASPECT 1.5
+#define BIN_AUTO_MAX_DIM 1024
+// -det: cGP2D cell scatter always uses this many private area planes
+#define BIN_DET_SCATTER_PARTS 8
 enum { SIN_SMOOTH, LIN_SMOOTH };
 #define SMOOTH_LAB LIN_SMOOTH /* SIN_SMOOTH   */
 
@@ -219,6 +349,26 @@ enum { NoneTemppre, AreaTemppre, DenTemppre };
 void den_comp(int cell_idx);
 inline void den_comp_2d_mGP2D(CELL *cell, TIER *tier);
 inline void den_comp_2d_cGP2D(CELL *cell, TIER *tier);
+void den_comp_2d_cGP2D_plane(CELL *cell, TIER *tier, prec *cellArea,
+                             prec *cellArea2, int *ovlpBin = NULL,
+                             prec *ovlpShare = NULL);
+
+// cell -> (bin index, area share) footprints of the last cGP2D scatter
+void bin_ovlp_build(TIER *tier, bool isFillerOnly);
+int bin_ovlp_get(int cellIdx, int **bins, prec **shares);
+int bin_ovlp_get_ctx(BIN_CTX *ctx, int cellIdx, FPOS pmin, FPOS pmax,
+                     int **bins, prec **shares);
+void bin_ovlp_delete(void);
+void bin_split_cells(TIER *tier);
+void bin_scatter_cells(TIER *tier, CELL **cells, int cnt, prec *dest);
+void bin_priv_init(TIER *tier, int planeCnt);
+void bin_priv_delete(void);
+
+// private density contexts for -specStep (see BIN_CTX)
+void bin_ctx_init(BIN_CTX *ctx, int threadCnt);
+void bin_ctx_delete(BIN_CTX *ctx);
+void bin_update_ctx(BIN_CTX *ctx, FPOS *st);
+void bin_ctx_adopt(BIN_CTX *ctx);
 void den_comp_3d(int cell_idx);
 
 // void    bin_zum_z ();
@@ -924,10 +924,10 @@ int read_nodes_3D(char *input) {
 
     prec x, y;
 
-#if PREC_MODE == IS_FLOAT
-    sscanf(line, "%s%f%f%s\n", nodeName, &x, &y, node_type);
-#elif PREC_MODE == IS_DOUBLE
+#if PREC_MODE == IS_DOUBLE
     sscanf(line, "%s%lf%lf%s\n", nodeName, &x, &y, node_type);
+#else
+    sscanf(line, "%s%f%f%s\n", nodeName, &x, &y, node_type);
 #endif
 
     // cout << "current parsed: " << nodeName << ", " << x<< ", " <<
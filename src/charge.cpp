@@ -390,67 +390,101 @@ void potn_grad_local(int cell_idx, struct FPOS *grad, prec *cellLambda) {
 }
 */
 
-void potn_grad_2D(int cell_idx, struct FPOS *grad) {
-  //    cout << "executed?" << endl;
-  //    exit(1);
-
-  assert(0 <= cell_idx && cell_idx < gcell_cnt);
+// field gather of cell with density box [pmin, pmax] on grid; the
+// footprint from the scatter is used when ovlpCnt >= 0
+static void PotnGrad2D(CELL *cell, TIER *tier, DEN_GRID *grid, FPOS pmin,
+                       FPOS pmax, int ovlpCnt, int *ovlpBin,
+                       prec *ovlpShare, struct FPOS *grad) {
   grad->SetZero();
 
-  POS b0, b1;
-
-  CELL *cell = &gcell_st[cell_idx];
-  TIER *tier = &tier_st[cell->tier];
- 
-  b0.x =
-      INT_CONVERT((cell->den_pmin.x - tier->bin_org.x) * tier->inv_bin_stp.x);
-  b0.y =
-      INT_CONVERT((cell->den_pmin.y - tier->bin_org.y) * tier->inv_bin_stp.y);
-  b1.x =
-      INT_CONVERT((cell->den_pmax.x - tier->bin_org.x) * tier->inv_bin_stp.x);
-  b1.y =
-      INT_CONVERT((cell->den_pmax.y - tier->bin_org.y) * tier->inv_bin_stp.y);
-
-
-  if(b0.x < 0)
-    b0.x = 0;
-  if(b0.x > tier->dim_bin.x - 1)
-    b0.x = tier->dim_bin.x - 1;
-  if(b0.y < 0)
-    b0.y = 0;
-  if(b0.y > tier->dim_bin.y - 1)
-    b0.y = tier->dim_bin.y - 1;
+  // reuse the footprint recorded by the density scatter
+  if(ovlpCnt >= 0) {
+    for(int k = 0; k < ovlpCnt; k++) {
+      grad->x += ovlpShare[k] * grid->ex[ovlpBin[k]];
+      grad->y += ovlpShare[k] * grid->ey[ovlpBin[k]];
+    }
+    return;
+  }
 
-  if(b1.x < 0)
-    b1.x = 0;
-  if(b1.x > tier->dim_bin.x - 1)
-    b1.x = tier->dim_bin.x - 1;
-  if(b1.y < 0)
-    b1.y = 0;
-  if(b1.y > tier->dim_bin.y - 1)
-    b1.y = tier->dim_bin.y - 1;
+  // same bin range as den_comp_2d_cGP2D
+  POS b0, b1;
+  GetDenBinRange(pmin, pmax, tier, &b0, &b1);
+
+  // large cells: fully covered bins come from the field SAT in O(1)
+  POS i0, i1;
+  bool isLarge = grid->is_sat_valid &&
+                 GetCoveredBinRange(pmin, pmax, tier, b0, b1, &i0, &i1) &&
+                 (i1.x - i0.x + 1) * (i1.y - i0.y + 1) >= DEN_DIFF_MIN_BINS;
+  if(isLarge) {
+    FPOS sum = GetFieldSumSAT(tier, i0, i1);
+    prec scal = tier->bin_area * cell->den_scal;
+    grad->x += scal * sum.x;
+    grad->y += scal * sum.y;
+  }
 
   BIN *bpx = NULL, *bpy = NULL;
   int x = 0, y = 0;
   int idx = b0.x * tier->dim_bin.y + b0.y;
 
   for(x = b0.x, bpx = &tier->bin_mat[idx]; x <= b1.x;
-      x++, bpx += tier->dim_bin.y) {
-    prec max_x = min(bpx->pmax.x, cell->den_pmax.x);
-    prec min_x = max(bpx->pmin.x, cell->den_pmin.x);
-
-    for(y = b0.y, bpy = bpx; y <= b1.y; y++, bpy++) {
-      prec max_y = min(bpy->pmax.y, cell->den_pmax.y);
-      prec min_y = max(bpy->pmin.y, cell->den_pmin.y);
+      x++, bpx += tier->dim_bin.y, idx += tier->dim_bin.y) {
+    prec max_x = min(bpx->pmax.x, pmax.x);
+    prec min_x = max(bpx->pmin.x, pmin.x);
+    bool isInnerCol = isLarge && i0.x <= x && x <= i1.x;
+
+    int bidx = idx;
+    for(y = b0.y, bpy = bpx; y <= b1.y; y++, bpy++, bidx++) {
+      // exact treatment only on the boundary ring
+      if(isInnerCol && y == i0.y) {
+        bpy += i1.y - y;
+        bidx += i1.y - y;
+        y = i1.y;
+        continue;
+      }
+      prec max_y = min(bpy->pmax.y, pmax.y);
+      prec min_y = max(bpy->pmin.y, pmin.y);
       prec area_share = (max_x - min_x) * (max_y - min_y)
                         //* cell->size.z
                         * cell->den_scal;
-      grad->x += area_share * bpy->e.x;
-      grad->y += area_share * bpy->e.y;
+      grad->x += area_share * grid->ex[bidx];
+      grad->y += area_share * grid->ey[bidx];
     }
   }
 }
 
+void potn_grad_2D(int cell_idx, struct FPOS *grad) {
+  //    cout << "executed?" << endl;
+  //    exit(1);
+
+  assert(0 <= cell_idx && cell_idx < gcell_cnt);
+
+  CELL *cell = &gcell_st[cell_idx];
+  TIER *tier = &tier_st[cell->tier];
+
+  int *ovlpBin = NULL;
+  prec *ovlpShare = NULL;
+  int ovlpCnt = bin_ovlp_get(cell_idx, &ovlpBin, &ovlpShare);
+  PotnGrad2D(cell, tier, tier->den_grid, cell->den_pmin, cell->den_pmax,
+             ovlpCnt, ovlpBin, ovlpShare, grad);
+}
+
+// potn_grad_2D on the field of ctx's last bin_update_ctx
+void potn_grad_2D_ctx(BIN_CTX *ctx, int cell_idx, struct FPOS *grad) {
+  assert(0 <= cell_idx && cell_idx < gcell_cnt);
+
+  CELL *cell = &gcell_st[cell_idx];
+  TIER *tier = &tier_st[cell->tier];
+  FPOS pmin, pmax;
+  GetDenBox(ctx, cell, &pmin, &pmax);
+
+  int *ovlpBin = NULL;
+  prec *ovlpShare = NULL;
+  int ovlpCnt =
+      bin_ovlp_get_ctx(ctx, cell_idx, pmin, pmax, &ovlpBin, &ovlpShare);
+  PotnGrad2D(cell, tier, ctx->grid, pmin, pmax, ovlpCnt, ovlpBin, ovlpShare,
+             grad);
+}
+
 void potn_grad_2D_local(int cell_idx, struct FPOS *grad, prec *cellLambda) {
   int x = 0, y = 0;
   int idx = 0;
@@ -476,6 +510,7 @@ void potn_grad_2D_local(int cell_idx, struct FPOS *grad, prec *cellLambda) {
   struct POS b0, b1;
   struct CELL *cell = &gcell_st[cell_idx];
   struct TIER *tier = &tier_st[cell->tier];
+  struct DEN_GRID *grid = tier->den_grid;
 
   grad->x = grad->y = 0;
 
@@ -525,6 +560,9 @@ void potn_grad_2D_local(int cell_idx, struct FPOS *grad, prec *cellLambda) {
     }  // else just add, then plus
 
     for(y = b0.y, bpy = bpx; y <= b1.y; y++, bpy++) {
+      int bidx = bpy - tier->bin_mat;
+      prec binCellArea = grid->cell_area[bidx];
+
       bpy_max_x = min(bpy->pmax.x, cell->pmax.x);
       bpy_min_x = max(bpy->pmin.x, cell->pmin.x);
       bpy_max_y = min(bpy->pmax.y, cell->den_pmax.y);
@@ -544,22 +582,22 @@ void potn_grad_2D_local(int cell_idx, struct FPOS *grad, prec *cellLambda) {
       area_share =
           (bpx_max_x - bpx_min_x) * (bpy_max_y - bpy_min_y) * cell->den_scal;
 
-      exp_term = fastExp(common_div * (bpy->cell_area - tier->bin_area));
-      // exp_term = exp (common_div * (bpy->cell_area - tier->bin_area));
+      exp_term = fastExp(common_div * (binCellArea - tier->bin_area));
+      // exp_term = exp (common_div * (binCellArea - tier->bin_area));
 
-      if((bpy->cell_area - tier->bin_area) > 0) {
+      if((binCellArea - tier->bin_area) > 0) {
         *cellLambda +=
-            BETA * (bpy->cell_area - tier->bin_area) * inv_total_modu_area;
+            BETA * (binCellArea - tier->bin_area) * inv_total_modu_area;
       }
 
-      common_val = common_div * bpy->phi * exp_term * bpy->cell_area;
+      common_val = common_div * grid->phi[bidx] * exp_term * binCellArea;
       common_mul = exp_term * area_share;
 
       grad->x += bpx_delta_x_movement * common_val;
-      grad->x += common_mul * bpy->e.x;
+      grad->x += common_mul * grid->ex[bidx];
 
       grad->y += bpy_delta_y_movement * common_val;
-      grad->y += common_mul * bpy->e.y;
+      grad->y += common_mul * grid->ey[bidx];
 
       ////igkang
       // if (cell->flg == FillerCell) continue;
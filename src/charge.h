@@ -68,6 +68,7 @@ inline void potn_pre(int cell_idx, struct FPOS *charge_dpre) {
 //void potn_grad(int cell_idx, struct FPOS *grad);
 //void potn_grad_local(int cell_idx, struct FPOS *grad, prec *cellLambda);
 void potn_grad_2D(int cell_idx, struct FPOS *grad);
+void potn_grad_2D_ctx(BIN_CTX *ctx, int cell_idx, struct FPOS *grad);
 void potn_grad_2D_local(int cell_idx, struct FPOS *grad, prec *cellLambda);
 
 #endif
@@ -0,0 +1,134 @@
+///////////////////////////////////////////////////////////////////////////////
+// Authors: Ilgweon Kang and Lutong Wang
+//          (respective Ph.D. advisors: Chung-Kuan Cheng, Andrew B. Kahng),
+//          based on Dr. Jingwei Lu with ePlace and ePlace-MS
+//
+//          Many subsequent improvements were made by Mingyu Woo
+//          leading up to the initial release.
+//
+// BSD 3-Clause License
+//
+// Copyright (c) 2018, The Regents of the University of California
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include "checkpoint.h"
+#include "util.h"
+
+using std::string;
+
+static std::thread ckpt_thread;
+static CKPT_BUF ckpt_pending;
+
+void ckpt_put(CKPT_BUF *buf, const void *src, size_t size) {
+  const char *p = (const char *)src;
+  buf->data.insert(buf->data.end(), p, p + size);
+}
+
+bool ckpt_get(CKPT_BUF *buf, void *dst, size_t size) {
+  if(buf->pos + size > buf->data.size()) {
+    return false;
+  }
+  memcpy(dst, &buf->data[buf->pos], size);
+  buf->pos += size;
+  return true;
+}
+
+static void WriteCheckpointFile(string fileName) {
+  string tmpName = fileName + ".tmp";
+  FILE *fp = fopen(tmpName.c_str(), "wb");
+  if(!fp) {
+    PrintInfoString("Checkpoint: cannot open", tmpName);
+    return;
+  }
+  size_t size = ckpt_pending.data.size();
+  bool isOk = (fwrite(ckpt_pending.data.data(), 1, size, fp) == size);
+  isOk = (fclose(fp) == 0) && isOk;
+  if(!isOk || rename(tmpName.c_str(), fileName.c_str()) != 0) {
+    PrintInfoString("Checkpoint: write failed", fileName);
+  }
+}
+
+static void JoinAtExit(void) {
+  ckpt_wait();
+}
+
+void ckpt_write_async(CKPT_BUF *buf, string fileName) {
+  // registered after ckpt_thread is constructed, so it runs before the
+  // thread's destructor on every exit() path (PrintError included)
+  static bool isAtExit = (atexit(JoinAtExit) == 0);
+  (void)isAtExit;
+
+  ckpt_wait();
+  ckpt_pending.data.swap(buf->data);
+  buf->data.clear();
+  buf->pos = 0;
+  ckpt_thread = std::thread(WriteCheckpointFile, fileName);
+}
+
+void ckpt_wait(void) {
+  if(ckpt_thread.joinable()) {
+    ckpt_thread.join();
+  }
+}
+
+bool ckpt_read(CKPT_BUF *buf, string fileName) {
+  FILE *fp = fopen(fileName.c_str(), "rb");
+  if(!fp) {
+    return false;
+  }
+  fseek(fp, 0, SEEK_END);
+  long size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+
+  buf->data.resize(size < 0 ? 0 : size);
+  buf->pos = 0;
+  bool isOk = (size >= 0) &&
+              (fread(buf->data.data(), 1, buf->data.size(), fp) ==
+               buf->data.size());
+  fclose(fp);
+  return isOk;
+}
+
+bool ckpt_read_header(string fileName, int *header) {
+  FILE *fp = fopen(fileName.c_str(), "rb");
+  if(!fp) {
+    return false;
+  }
+  char magic[8];
+  bool isOk = (fread(magic, 1, sizeof(magic), fp) == sizeof(magic)) &&
+              strncmp(magic, CKPT_MAGIC, sizeof(magic)) == 0 &&
+              (fread(header, sizeof(int), CKPT_H_CNT, fp) == CKPT_H_CNT);
+  fclose(fp);
+  return isOk;
+}
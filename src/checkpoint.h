@@ -0,0 +1,97 @@
+///////////////////////////////////////////////////////////////////////////////
+// Authors: Ilgweon Kang and Lutong Wang
+//          (respective Ph.D. advisors: Chung-Kuan Cheng, Andrew B. Kahng),
+//          based on Dr. Jingwei Lu with ePlace and ePlace-MS
+//
+//          Many subsequent improvements were made by Mingyu Woo
+//          leading up to the initial release.
+//
+// BSD 3-Clause License
+//
+// Copyright (c) 2018, The Regents of the University of California
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __PL_CHECKPOINT__
+#define __PL_CHECKPOINT__
+
+#include <string>
+#include <vector>
+
+// -ckpt / -resume: versioned binary image of the Nesterov state.
+// The image starts with CKPT_MAGIC and CKPT_VERSION; bump the version
+// whenever the field list in myNesterov::SaveCheckpoint changes.
+#define CKPT_MAGIC "RPLCKPT"
+#define CKPT_VERSION 1
+
+// header ints following the magic
+enum CKPT_HEADER {
+  CKPT_H_VERSION,
+  CKPT_H_PREC,      // sizeof(prec)
+  CKPT_H_PREC_ACC,  // sizeof(prec_acc)
+  CKPT_H_STAGE,
+  CKPT_H_N,
+  CKPT_H_MAX_ITER,
+  CKPT_H_ITER,
+  CKPT_H_CNT
+};
+
+struct CKPT_BUF {
+  std::vector< char > data;
+  size_t pos;  // read cursor
+
+  CKPT_BUF() : pos(0) {}
+};
+
+void ckpt_put(CKPT_BUF *buf, const void *src, size_t size);
+bool ckpt_get(CKPT_BUF *buf, void *dst, size_t size);
+
+template < class T >
+inline void ckpt_put(CKPT_BUF *buf, const T &val) {
+  ckpt_put(buf, &val, sizeof(T));
+}
+
+template < class T >
+inline bool ckpt_get(CKPT_BUF *buf, T *val) {
+  return ckpt_get(buf, val, sizeof(T));
+}
+
+// hands buf's image to the background writer (buf is left empty) and
+// returns; the previous write is joined first. The file is written under
+// a temporary name and renamed, so a killed job leaves the last complete
+// checkpoint. The writer is also joined at exit(), so error exits do not
+// destroy a running std::thread.
+void ckpt_write_async(CKPT_BUF *buf, std::string fileName);
+void ckpt_wait(void);
+
+bool ckpt_read(CKPT_BUF *buf, std::string fileName);
+// magic and CKPT_H_CNT header ints only; false when not a checkpoint
+bool ckpt_read_header(std::string fileName, int *header);
+
+#endif
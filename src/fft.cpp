@@ -43,8 +43,15 @@
 #include <cmath>
 #include <cfloat>
 
+#include <omp.h>
+#include <cstring>
+
 #include "fft.h"
 
+#ifdef USE_FFTW
+#include <fftw3.h>
+#endif
+
 int *charge_ip_2d;
 int *charge_ip_3d;
 int charge_dft_n_2d;
@@ -56,14 +63,18 @@ int charge_dft_nbit_3d;
 int charge_dft_nw_2d;
 int charge_dft_nw_3d;
 prec **den_2d_st2;
+prec *den_2d_plane;
 prec ***den_3d_st3;
 prec **phi_2d_st2;
+prec *phi_2d_plane;
 prec ***phi_3d_st3;
 prec **e_2d_st2;
 prec ***e_3d_st3;
 prec **ex_2d_st2;
+prec *ex_2d_plane;
 prec ***ex_3d_st3;
 prec **ey_2d_st2;
+prec *ey_2d_plane;
 prec ***ey_3d_st3;
 prec **ez_2d_st2;
 prec ***ez_3d_st3;
@@ -85,21 +96,51 @@ prec *wx_2d_iL;
 prec *wy_2d_iL;
 prec *wx2_2d_iL;
 prec *wy2_2d_iL;
+prec *green_2d_plane;
 
 prec DFT_SCALE_2D;
 prec DFT_SCALE_3D;
 struct POS dft_bin_2d;
 struct POS dft_bin_3d;
 
+struct DCT2D_ENGINE dct_engine_2d;
+
 void charge_fft_init(struct POS nbin, struct FPOS stp, int flg) {
   charge_fft_init_2d(nbin, stp);
 }
 
+// per-grid buffers of charge_fft_init_2d; NULL after the free, so it is
+// safe on a grid that was never set up
+static void FreeChargeBuf2d(void) {
+  free(den_2d_st2);
+  free(phi_2d_st2);
+  free(ex_2d_st2);
+  free(ey_2d_st2);
+  den_2d_st2 = phi_2d_st2 = ex_2d_st2 = ey_2d_st2 = NULL;
+  free(den_2d_plane);
+  free(phi_2d_plane);
+  free(ex_2d_plane);
+  free(ey_2d_plane);
+  den_2d_plane = phi_2d_plane = ex_2d_plane = ey_2d_plane = NULL;
+  free(wx_2d_st);
+  free(wy_2d_st);
+  free(wx2_2d_st);
+  free(wy2_2d_st);
+  wx_2d_st = wy_2d_st = wx2_2d_st = wy2_2d_st = NULL;
+  free(green_2d_plane);
+  green_2d_plane = NULL;
+}
+
 void charge_fft_init_2d(struct POS nbin, struct FPOS stp) {
   // Descriptions for parameters are in fftsg2d.cpp.
   // See DCT section.  Line 200 in fftsg2d.cpp
   int x = 0;
   int y = 0;
+
+  // setup_before_opt() sets up the msh grid and the mGP2D / cGP2D setup
+  // then calls this again without a delete in between
+  FreeChargeBuf2d();
+
   dft_bin_2d = nbin;
   charge_dft_n_2d = p_max(dft_bin_2d);
   charge_dft_nbin_2d = p_product(dft_bin_2d);
@@ -110,18 +151,36 @@ void charge_fft_init_2d(struct POS nbin, struct FPOS stp) {
   ex_2d_st2 = (prec **)malloc(sizeof(prec *) * dft_bin_2d.x);
   ey_2d_st2 = (prec **)malloc(sizeof(prec *) * dft_bin_2d.x);
 
+  // each field is one contiguous plane (x-major, same order as bin_mat);
+  // *_2d_st2 are row pointers into it for the Ooura routines.
+  den_2d_plane = AllocAlignedPrec(charge_dft_nbin_2d);
+  phi_2d_plane = AllocAlignedPrec(charge_dft_nbin_2d);
+  ex_2d_plane = AllocAlignedPrec(charge_dft_nbin_2d);
+  ey_2d_plane = AllocAlignedPrec(charge_dft_nbin_2d);
+
   for(x = 0; x < dft_bin_2d.x; x++) {
-    den_2d_st2[x] = (prec *)malloc(sizeof(prec) * dft_bin_2d.y);
-    phi_2d_st2[x] = (prec *)malloc(sizeof(prec) * dft_bin_2d.y);
-    ex_2d_st2[x] = (prec *)malloc(sizeof(prec) * dft_bin_2d.y);
-    ey_2d_st2[x] = (prec *)malloc(sizeof(prec) * dft_bin_2d.y);
+    den_2d_st2[x] = &den_2d_plane[x * dft_bin_2d.y];
+    phi_2d_st2[x] = &phi_2d_plane[x * dft_bin_2d.y];
+    ex_2d_st2[x] = &ex_2d_plane[x * dft_bin_2d.y];
+    ey_2d_st2[x] = &ey_2d_plane[x * dft_bin_2d.y];
   }
 
   charge_dft_nbit_2d = 2 + (int)sqrt((prec)charge_dft_n_2d + 0.5);
-  charge_ip_2d = (int *)malloc(sizeof(int) * charge_dft_nbit_2d);
   charge_dft_nw_2d = charge_dft_n_2d * 3 / 2;
-  w_2d = (prec *)malloc(sizeof(prec) * charge_dft_nw_2d);
-  charge_ip_2d[0] = 0;
+
+  // twiddle / bit-reversal tables are owned by the engine. On the second
+  // call of a setup, keep it (and its measured FFTW plans) if the grid and
+  // thread count did not change; charge_fft_delete_2d() drops it.
+  DCT2D_ENGINE *eng = &dct_engine_2d;
+  if(eng->ip && (eng->n1 != dft_bin_2d.x || eng->n2 != dft_bin_2d.y ||
+                 eng->numThread != numThread)) {
+    dct2d_engine_delete(eng);
+  }
+  if(!eng->ip) {
+    dct2d_engine_init(eng, dft_bin_2d.x, dft_bin_2d.y, numThread);
+  }
+  charge_ip_2d = dct_engine_2d.ip;
+  w_2d = dct_engine_2d.w;
 
   wx_2d_st = (prec *)malloc(sizeof(prec) * dft_bin_2d.x);
   wy_2d_st = (prec *)malloc(sizeof(prec) * dft_bin_2d.y);
@@ -143,6 +202,23 @@ void charge_fft_init_2d(struct POS nbin, struct FPOS stp) {
     // wy_2d_st [y]= PI * (prec  )y / ((prec  )dft_bin_2d.y * stp.y);
     wy2_2d_st[y] = wy_2d_st[y] * wy_2d_st[y];
   }
+
+  // spectral Poisson kernel with the DCT normalization folded in
+  green_2d_plane = AllocAlignedPrec(charge_dft_nbin_2d);
+  for(x = 0; x < dft_bin_2d.x; x++) {
+    for(y = 0; y < dft_bin_2d.y; y++) {
+      prec scal = 4.0 / dft_bin_2d.x / dft_bin_2d.y;
+      if(x == 0) {
+        scal *= 0.5;
+      }
+      if(y == 0) {
+        scal *= 0.5;
+      }
+      prec denom = wx2_2d_st[x] + wy2_2d_st[y];
+      green_2d_plane[x * dft_bin_2d.y + y] =
+          (x == 0 && y == 0) ? 0.0 : scal / denom;
+    }
+  }
 }
 
 /*
@@ -214,80 +290,401 @@ void charge_fft_call(int flg) {
 }
 
 void charge_fft_call_2d(void) {
+  charge_fft_solve_2d(&dct_engine_2d, den_2d_plane, phi_2d_plane,
+                      ex_2d_plane, ey_2d_plane);
+}
+
+// Poisson solve of one density plane: den is transformed in place and
+// phi / ex / ey receive the potential and field. The planes and the
+// engine may be a -specStep candidate's (see bin_ctx_init).
+void charge_fft_solve_2d(DCT2D_ENGINE *eng, prec *den, prec *phi, prec *ex,
+                         prec *ey) {
   // Descriptions for parameters are in fftsg2d.cpp.
   // See DCT section.  Line 200 in fftsg2d.cpp
   int x = 0;
-  int y = 0;
   int n1 = dft_bin_2d.x;
   int n2 = dft_bin_2d.y;
-  prec a_den = 0;
-  prec a_phi = 0;
-  prec denom = 0;
-  prec a_ex = 0;
-  prec a_ey = 0;
-  prec wx = 0;
-  prec wx2 = 0;
-  prec wy = 0;
-  prec wy2 = 0;
-
-  ddct2d(n1, n2, -1, den_2d_st2, NULL, charge_ip_2d, w_2d);
 
+  dct2d_engine_call(eng, DCT2D_FWD, den);
+
+  // one sweep: the DC halving, the 4/(n1*n2) scale and 1/(wx2+wy2) are
+  // all folded into green_2d_plane
+  omp_set_num_threads(binThread);
+#pragma omp parallel for default(none) shared(n1, n2, den, phi, ex, ey, \
+    green_2d_plane, wx_2d_st, wy_2d_st) private(x)
   for(x = 0; x < n1; x++) {
-    den_2d_st2[x][0] *= 0.5;
+    const prec *denRow = den + (size_t)x * n2;
+    const prec *green = green_2d_plane + (size_t)x * n2;
+    prec *phiRow = phi + (size_t)x * n2;
+    prec *exRow = ex + (size_t)x * n2;
+    prec *eyRow = ey + (size_t)x * n2;
+    const prec *wy = wy_2d_st;
+    prec wx = wx_2d_st[x];
+
+#pragma omp simd
+    for(int y = 0; y < n2; y++) {
+      prec a_phi = denRow[y] * green[y];
+      phiRow[y] = a_phi;
+      exRow[y] = a_phi * wx;
+      eyRow[y] = a_phi * wy[y];
+    }
   }
 
-  for(y = 0; y < n2; y++) {
-    den_2d_st2[0][y] *= 0.5;
+  static const DCT2D_KIND invKind[3] = {DCT2D_INV, DCT2D_INV_SC,
+                                        DCT2D_INV_CS};
+  prec *invPlane[3] = {phi, ex, ey};
+  dct2d_engine_call_multi(eng, 3, invKind, invPlane);
+}
+
+#ifdef USE_FFTW
+#if PREC_MODE != IS_DOUBLE
+#define FFTW(name) fftwf_##name
+#else
+#define FFTW(name) fftw_##name
+#endif
+#endif
+
+void makewt(int nw, int *ip, prec *w);
+void makect(int nc, int *ip, prec *c);
+
+void dct2d_engine_init(DCT2D_ENGINE *eng, int n1, int n2, int nThread) {
+  // Ooura tables only serve the power-of-two axes
+  int n = 0;
+  if(IsPow2(n1)) {
+    n = n1;
   }
+  if(IsPow2(n2) && n2 > n) {
+    n = n2;
+  }
+  int nw = n >> 2;
+  int nc = n;
 
-  for(x = 0; x < n1; x++) {
-    for(y = 0; y < n2; y++) {
-      den_2d_st2[x][y] *= 4.0 / n1 / n2;
+  eng->n1 = n1;
+  eng->n2 = n2;
+  eng->numThread = (nThread < 1) ? 1 : nThread;
+
+  // build the tables up front, so the 1D calls only read them and
+  // can run from several threads at once
+  eng->ip = (int *)malloc(sizeof(int) * (2 + (int)sqrt((prec)n + 0.5)));
+  eng->w = (prec *)malloc(sizeof(prec) * (nw + nc + 1));
+  eng->ip[0] = eng->ip[1] = 0;
+  if(nw > 0) {
+    makewt(nw, eng->ip, eng->w);
+  }
+  if(nc > 0) {
+    makect(nc, eng->ip, eng->w + nw);
+  }
+  eng->mr[0] = eng->mr[1] = NULL;
+  eng->mrWork = NULL;
+  eng->mrWorkCnt = 0;
+  eng->lane[0] = eng->lane[1] = NULL;
+  eng->laneBuf = NULL;
+  eng->laneBufCnt = 0;
+
+#ifdef USE_FFTW
+  eng->buf = AllocAlignedPrec((size_t)n1 * n2);
+
+  // plan out-of-place from buf; the target plane is given per call
+  prec *out = AllocAlignedPrec((size_t)n1 * n2);
+  FFTW(r2r_kind) kind[4][2] = {{FFTW_REDFT10, FFTW_REDFT10},
+                               {FFTW_REDFT01, FFTW_REDFT01},
+                               {FFTW_RODFT01, FFTW_REDFT01},
+                               {FFTW_REDFT01, FFTW_RODFT01}};
+  // FFTW_MEASURE picks among timed plans and the threaded split follows
+  // the thread count, so -det plans by estimate on a single thread
+#ifdef USE_FFTW_THREADS
+  FFTW(init_threads)();
+  FFTW(plan_with_nthreads)(isDeterministic ? 1 : eng->numThread);
+#endif
+  unsigned planFlag = isDeterministic ? FFTW_ESTIMATE : FFTW_MEASURE;
+  for(int i = 0; i < 4; i++) {
+    eng->plan[i] = (void *)FFTW(plan_r2r_2d)(n1, n2, eng->buf, out, kind[i][0],
+                                             kind[i][1], planFlag);
+  }
+  free(out);
+#else
+  // four columns per block and thread, as in ddxt2d_sub
+  eng->buf = AllocAlignedPrec((size_t)4 * n1 * eng->numThread);
+
+  // power-of-two axes run DCTV_LANES lines per call, other lengths go
+  // through the mixed-radix path
+  int len[2] = {n1, n2};
+  for(int i = 0; i < 2; i++) {
+    if(IsPow2(len[i])) {
+      eng->lane[i] = dctv_plan_create(len[i]);
+      size_t cnt = len[i] + dctv_work_size(eng->lane[i]);
+      if(cnt > eng->laneBufCnt) {
+        eng->laneBufCnt = cnt;
+      }
+      continue;
+    }
+    eng->mr[i] = mrdct_plan_create(len[i]);
+    size_t cnt = mrdct_work_size(eng->mr[i]);
+    if(cnt > eng->mrWorkCnt) {
+      eng->mrWorkCnt = cnt;
     }
   }
+  if(eng->mrWorkCnt > 0) {
+    eng->mrWork = (double *)malloc(sizeof(double) * eng->mrWorkCnt *
+                                   eng->numThread);
+  }
+  if(eng->laneBufCnt > 0) {
+    eng->laneBuf = (dctv_t *)AllocAlignedPrec(
+        eng->laneBufCnt * DCTV_LANES * eng->numThread);
+  }
+#endif
+}
 
-  for(x = 0; x < n1; x++) {
-    wx = wx_2d_st[x];
-    wx2 = wx2_2d_st[x];
+void dct2d_engine_delete(DCT2D_ENGINE *eng) {
+#ifdef USE_FFTW
+  for(int i = 0; i < 4; i++) {
+    FFTW(destroy_plan)((FFTW(plan))eng->plan[i]);
+  }
+#endif
+  mrdct_plan_delete(eng->mr[0]);
+  mrdct_plan_delete(eng->mr[1]);
+  free(eng->mrWork);
+  dctv_plan_delete(eng->lane[0]);
+  dctv_plan_delete(eng->lane[1]);
+  free(eng->laneBuf);
+  free(eng->ip);
+  free(eng->w);
+  free(eng->buf);
+  eng->mr[0] = eng->mr[1] = NULL;
+  eng->mrWork = NULL;
+  eng->lane[0] = eng->lane[1] = NULL;
+  eng->laneBuf = NULL;
+  eng->ip = NULL;
+  eng->w = NULL;
+  eng->buf = NULL;
+}
 
-    for(y = 0; y < n2; y++) {
-      wy = wy_2d_st[y];
-      wy2 = wy2_2d_st[y];
+#ifdef USE_FFTW
 
-      a_den = den_2d_st2[x][y];
+// FFTW's REDFTxx/RODFTxx differ from Ooura's ddct/ddst by a factor of
+// two per axis, by the weight of the first cosine term, and (for the
+// inverse sine) by the slot holding the highest frequency. Adjust the
+// input while copying it to buf; the transform is linear, so the 1/4
+// of the two axes is applied in the same pass.
+void dct2d_engine_call(DCT2D_ENGINE *eng, DCT2D_KIND kind, prec *a) {
+  int n1 = eng->n1, n2 = eng->n2;
+  prec *buf = eng->buf;
+  int i = 0, j = 0;
 
-      if(x == 0 && y == 0) {
-        a_phi = 0.0;
-        a_ex = 0.0;
-        a_ey = 0.0;
+  switch(kind) {
+    case DCT2D_FWD:
+      for(i = 0; i < n1 * n2; i++) {
+        buf[i] = 0.25 * a[i];
+      }
+      break;
+    case DCT2D_INV:
+      for(i = 0; i < n1 * n2; i++) {
+        buf[i] = 0.25 * a[i];
+      }
+      for(j = 0; j < n2; j++) {
+        buf[j] *= 2.0;
+      }
+      for(i = 0; i < n1; i++) {
+        buf[i * n2] *= 2.0;
+      }
+      break;
+    case DCT2D_INV_SC:
+      // sine along x: A[i + 1] -> slot i, A[n1] (kept in a[0]) -> n1 - 1
+      for(i = 0; i < (n1 - 1) * n2; i++) {
+        buf[i] = 0.25 * a[n2 + i];
+      }
+      for(j = 0; j < n2; j++) {
+        buf[(n1 - 1) * n2 + j] = 0.5 * a[j];
+      }
+      for(i = 0; i < n1; i++) {
+        buf[i * n2] *= 2.0;
+      }
+      break;
+    case DCT2D_INV_CS:
+      // sine along y
+      for(i = 0; i < n1; i++) {
+        for(j = 0; j < n2 - 1; j++) {
+          buf[i * n2 + j] = 0.25 * a[i * n2 + j + 1];
+        }
+        buf[i * n2 + n2 - 1] = 0.5 * a[i * n2];
       }
-      else {
-        //////////// lutong
-        //  denom =
-        //  wx2 / 4.0 +
-        //  wy2 / 4.0 ;
-        // a_phi = a_den / denom ;
-        ////b_phi = 0 ; // -1.0 * b / denom ;
-        ////a_ex = 0 ; // b_phi * wx ;
-        // a_ex = a_phi * wx / 2.0 ;
-        ////a_ey = 0 ; // b_phi * wy ;
-        // a_ey = a_phi * wy / 2.0 ;
-        ///////////
-        denom = wx2 + wy2;
-        a_phi = a_den / denom;
-        a_ex = a_phi * wx;
-        a_ey = a_phi * wy;
+      for(j = 0; j < n2; j++) {
+        buf[j] *= 2.0;
+      }
+      break;
+  }
+
+  FFTW(execute_r2r)((FFTW(plan))eng->plan[kind], buf, a);
+}
+
+// Not batched: the phi / ex / ey planes use three different r2r kinds,
+// and a plan_many_r2r applies one kind per axis to every transform, so
+// each plane runs its own plan (threaded with USE_FFTW_THREADS).
+void dct2d_engine_call_multi(DCT2D_ENGINE *eng, int cnt,
+                             const DCT2D_KIND *kind, prec **a) {
+  for(int f = 0; f < cnt; f++) {
+    dct2d_engine_call(eng, kind[f], a[f]);
+  }
+}
+
+#else
+
+// 1D transform of a non power-of-two axis (0: x / columns, 1: y / rows)
+static inline void Dct1D(DCT2D_ENGINE *eng, int axis, int isSin, int isgn,
+                         prec *a, double *work) {
+  if(isSin) {
+    mrdst(eng->mr[axis], isgn, a, work);
+  }
+  else {
+    mrdct(eng->mr[axis], isgn, a, work);
+  }
+}
+
+// DCTV_LANES lines of a power-of-two axis, from line0 on: gather them
+// into lane order, transform, scatter back. Lanes past the last line
+// are zero.
+static void DctLanes(DCT2D_ENGINE *eng, int axis, int isSin, int isgn,
+                     prec *a, int line0, dctv_t *v) {
+  int n1 = eng->n1, n2 = eng->n2;
+  DCTV_PLAN *plan = eng->lane[axis];
+  int n = (axis == 0) ? n1 : n2;
+  int lineCnt = (axis == 0) ? n2 : n1;
+  int cnt = (lineCnt - line0 < DCTV_LANES) ? lineCnt - line0 : DCTV_LANES;
+  dctv_t *work = v + n;
+  dctv_t zero = {};
+
+  if(axis == 0) {
+    // columns: the lines of one row are adjacent
+    for(int r = 0; r < n; r++) {
+      const prec *src = a + (size_t)r * n2 + line0;
+      v[r] = zero;
+      for(int k = 0; k < cnt; k++) {
+        v[r][k] = src[k];
+      }
+    }
+  }
+  else {
+    for(int j = 0; j < n; j++) {
+      v[j] = zero;
+    }
+    for(int k = 0; k < cnt; k++) {
+      const prec *src = a + (size_t)(line0 + k) * n2;
+      for(int j = 0; j < n; j++) {
+        v[j][k] = src[j];
+      }
+    }
+  }
+
+  if(isSin) {
+    dstv(plan, isgn, v, work);
+  }
+  else {
+    dctv(plan, isgn, v, work);
+  }
+
+  if(axis == 0) {
+    for(int r = 0; r < n; r++) {
+      prec *dst = a + (size_t)r * n2 + line0;
+      for(int k = 0; k < cnt; k++) {
+        dst[k] = v[r][k];
+      }
+    }
+  }
+  else {
+    for(int k = 0; k < cnt; k++) {
+      prec *dst = a + (size_t)(line0 + k) * n2;
+      for(int j = 0; j < n; j++) {
+        dst[j] = v[j][k];
       }
-      phi_2d_st2[x][y] = a_phi;
-      ex_2d_st2[x][y] = a_ex;
-      ey_2d_st2[x][y] = a_ey;
     }
   }
-  ddct2d(n1, n2, 1, phi_2d_st2, NULL, charge_ip_2d, w_2d);
-  ddsct2d(n1, n2, 1, ex_2d_st2, NULL, charge_ip_2d, w_2d);
-  ddcst2d(n1, n2, 1, ey_2d_st2, NULL, charge_ip_2d, w_2d);
 }
 
+// Row pass along y, then column pass along x, for up to
+// DCT2D_MAX_FIELDS planes at once. Power-of-two axes go DCTV_LANES
+// lines at a time; other lengths row by row, and column-wise over
+// blocks of four columns. The fields are interleaved per block so the
+// twiddles for a given length stay hot, and one OpenMP team serves
+// both passes.
+static void DctMulti(DCT2D_ENGINE *eng, int cnt, const DCT2D_KIND *kind,
+                     prec **a) {
+  int n1 = eng->n1, n2 = eng->n2;
+  prec *buf = eng->buf;
+  int rowStep = eng->lane[1] ? DCTV_LANES : 1;
+  int colStep = eng->lane[0] ? DCTV_LANES : 4;
+  int i = 0, b = 0;
+
+  int isgn[DCT2D_MAX_FIELDS];
+  int isRowSin[DCT2D_MAX_FIELDS];
+  int isColSin[DCT2D_MAX_FIELDS];
+  for(int f = 0; f < cnt; f++) {
+    isgn[f] = (kind[f] == DCT2D_FWD) ? -1 : 1;
+    isRowSin[f] = (kind[f] == DCT2D_INV_CS);
+    isColSin[f] = (kind[f] == DCT2D_INV_SC);
+  }
+
+  omp_set_num_threads(eng->numThread < binThread ? eng->numThread : binThread);
+#pragma omp parallel default(none)                                     \
+    shared(eng, n1, n2, buf, rowStep, colStep, cnt, a, isgn, isRowSin, \
+           isColSin) private(i, b)
+  {
+    int tid = omp_get_thread_num();
+    double *work = eng->mrWork ? eng->mrWork + eng->mrWorkCnt * tid : NULL;
+    dctv_t *v = eng->laneBuf ? eng->laneBuf + eng->laneBufCnt * tid : NULL;
+
+#pragma omp for
+    for(i = 0; i < n1; i += rowStep) {
+      for(int f = 0; f < cnt; f++) {
+        if(eng->lane[1]) {
+          DctLanes(eng, 1, isRowSin[f], isgn[f], a[f], i, v);
+        }
+        else {
+          Dct1D(eng, 1, isRowSin[f], isgn[f], a[f] + (size_t)i * n2, work);
+        }
+      }
+    }
+
+    prec *t = buf + (size_t)4 * n1 * tid;
+
+#pragma omp for
+    for(b = 0; b < n2; b += colStep) {
+      for(int f = 0; f < cnt; f++) {
+        if(eng->lane[0]) {
+          DctLanes(eng, 0, isColSin[f], isgn[f], a[f], b, v);
+          continue;
+        }
+        int blk = (n2 - b < 4) ? n2 - b : 4;
+        prec *af = a[f];
+        for(int r = 0; r < n1; r++) {
+          for(int k = 0; k < blk; k++) {
+            t[k * n1 + r] = af[(size_t)r * n2 + b + k];
+          }
+        }
+        for(int k = 0; k < blk; k++) {
+          Dct1D(eng, 0, isColSin[f], isgn[f], t + k * n1, work);
+        }
+        for(int r = 0; r < n1; r++) {
+          for(int k = 0; k < blk; k++) {
+            af[(size_t)r * n2 + b + k] = t[k * n1 + r];
+          }
+        }
+      }
+    }
+  }
+}
+
+void dct2d_engine_call(DCT2D_ENGINE *eng, DCT2D_KIND kind, prec *a) {
+  DctMulti(eng, 1, &kind, &a);
+}
+
+void dct2d_engine_call_multi(DCT2D_ENGINE *eng, int cnt,
+                             const DCT2D_KIND *kind, prec **a) {
+  assert(cnt <= DCT2D_MAX_FIELDS);
+  DctMulti(eng, cnt, kind, a);
+}
+
+#endif
+
 /*
 void charge_fft_call_3d(void) {
   int x = 0, y = 0, z = 0;
@@ -800,16 +1197,10 @@ void charge_fft_delete_2d(void) {
   //    free (ex_2d_st2 [i]);
   //    free (ey_2d_st2 [i]);
   //}
-  free(den_2d_st2);
-  free(phi_2d_st2);
-  free(ex_2d_st2);
-  free(ey_2d_st2);
-  free(charge_ip_2d);
-  free(w_2d);
-  free(wx_2d_st);
-  free(wy_2d_st);
-  free(wx2_2d_st);
-  free(wy2_2d_st);
+  FreeChargeBuf2d();
+  dct2d_engine_delete(&dct_engine_2d);
+  charge_ip_2d = NULL;
+  w_2d = NULL;
 }
 
 // void thermal_fft_delete_2d (void) {
@@ -57,14 +57,18 @@ extern int charge_dft_nbit_3d;
 extern int charge_dft_nw_2d;
 extern int charge_dft_nw_3d;
 extern prec **den_2d_st2;
+extern prec *den_2d_plane;
 extern prec ***den_3d_st3;
 extern prec **phi_2d_st2;
+extern prec *phi_2d_plane;
 extern prec ***phi_3d_st3;
 extern prec **e_2d_st2;
 extern prec ***e_3d_st3;
 extern prec **ex_2d_st2;
+extern prec *ex_2d_plane;
 extern prec ***ex_3d_st3;
 extern prec **ey_2d_st2;
+extern prec *ey_2d_plane;
 extern prec ***ey_3d_st3;
 extern prec **ez_2d_st2;
 extern prec ***ez_3d_st3;
@@ -98,6 +102,7 @@ extern prec *wx_2d_iL;
 extern prec *wy_2d_iL;
 extern prec *wx2_2d_iL;
 extern prec *wy2_2d_iL;
+extern prec *green_2d_plane;
 
 // extern  prec            *thermal_w_2d;
 // extern  prec            *thermal_w_3d;
@@ -170,6 +175,78 @@ inline void copy_den_to_fft_2D(prec den, struct POS p) {
 // void copy_theta_from_fft      (prec   *phi, struct POS p, int flg);
 // void copy_powerDensity_to_fft (prec   powerDensity, struct POS p, int flg);
 
+/// 1D mixed-radix DCT (fftmr.cpp) //////////////////////////////////////
+// any length n; same conventions as ddct() / ddst()
+struct MRDCT_PLAN;
+struct MRDCT_PLAN *mrdct_plan_create(int n);
+void mrdct_plan_delete(struct MRDCT_PLAN *plan);
+size_t mrdct_work_size(const struct MRDCT_PLAN *plan);
+void mrdct(const struct MRDCT_PLAN *plan, int isgn, prec *a, double *work);
+void mrdst(const struct MRDCT_PLAN *plan, int isgn, prec *a, double *work);
+
+/// 1D lane-parallel DCT (fftv.cpp) ////////////////////////////////////
+// n = 2^k; DCTV_LANES independent lines at once, a[j] holding element j
+// of every line; same conventions as ddct() / ddst()
+#define DCTV_BYTES 32
+typedef prec dctv_t __attribute__((vector_size(DCTV_BYTES)));
+#define DCTV_LANES ((int)(DCTV_BYTES / sizeof(prec)))
+
+struct DCTV_PLAN;
+struct DCTV_PLAN *dctv_plan_create(int n);
+void dctv_plan_delete(struct DCTV_PLAN *plan);
+size_t dctv_work_size(const struct DCTV_PLAN *plan);
+void dctv(const struct DCTV_PLAN *plan, int isgn, dctv_t *a, dctv_t *work);
+void dstv(const struct DCTV_PLAN *plan, int isgn, dctv_t *a, dctv_t *work);
+
+inline bool IsPow2(int n) {
+  return n >= 2 && (n & (n - 1)) == 0;
+}
+
+/// 2D DCT engine ////////////////////////////////////////////////////////
+// The Poisson solve transforms; every kind works in place on an x-major
+// n1 x n2 plane and keeps the Ooura conventions of the matching *2d call.
+enum DCT2D_KIND {
+  DCT2D_FWD,     // ddct2d (-1)
+  DCT2D_INV,     // ddct2d (1)
+  DCT2D_INV_SC,  // ddsct2d(1): sine along x, cosine along y
+  DCT2D_INV_CS   // ddcst2d(1): cosine along x, sine along y
+};
+
+#define DCT2D_MAX_FIELDS 4
+
+struct DCT2D_ENGINE {
+  int n1;
+  int n2;
+  int numThread;
+  int *ip;    // bit-reversal work area, built once
+  prec *w;    // cos/sin twiddles, built once
+  prec *buf;  // aligned scratch: per-thread column blocks (Ooura)
+              // or the pre-processed input plane (FFTW)
+  struct MRDCT_PLAN *mr[2];  // x / y plans for non power-of-two lengths
+  double *mrWork;            // mixed-radix work, mrWorkCnt per thread
+  size_t mrWorkCnt;
+  struct DCTV_PLAN *lane[2];  // x / y plans for power-of-two lengths
+  dctv_t *laneBuf;            // lines + lane work, laneBufCnt per thread
+  size_t laneBufCnt;
+#ifdef USE_FFTW
+  void *plan[4];
+#endif
+};
+
+extern struct DCT2D_ENGINE dct_engine_2d;
+
+void dct2d_engine_init(struct DCT2D_ENGINE *eng, int n1, int n2,
+                       int nThread);
+void dct2d_engine_delete(struct DCT2D_ENGINE *eng);
+void dct2d_engine_call(struct DCT2D_ENGINE *eng, enum DCT2D_KIND kind,
+                       prec *a);
+// several planes in one pass, e.g. phi / ex / ey of the Poisson solve
+void dct2d_engine_call_multi(struct DCT2D_ENGINE *eng, int cnt,
+                             const enum DCT2D_KIND *kind, prec **a);
+// Poisson solve on explicit planes; charge_fft_call_2d uses the globals
+void charge_fft_solve_2d(struct DCT2D_ENGINE *eng, prec *den, prec *phi,
+                         prec *ex, prec *ey);
+
 /// 1D FFT ////////////////////////////////////////////////////////////////
 void cdft(int n, int isgn, prec *a, int *ip, prec *w);
 void ddct(int n, int isgn, prec *a, int *ip, prec *w);
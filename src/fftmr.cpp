@@ -0,0 +1,329 @@
+///////////////////////////////////////////////////////////////////////////////
+// Authors: Ilgweon Kang and Lutong Wang
+//          (respective Ph.D. advisors: Chung-Kuan Cheng, Andrew B. Kahng),
+//          based on Dr. Jingwei Lu with ePlace and ePlace-MS
+//
+//          Many subsequent improvements were made by Mingyu Woo
+//          leading up to the initial release.
+//
+// BSD 3-Clause License
+//
+// Copyright (c) 2018, The Regents of the University of California
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///////////////////////////////////////////////////////////////////////////////
+
+// The factorization (MrFactor), the recursive decimation (MrWork) and the
+// radix-2/3/4/generic butterflies (MrBfly*) follow kissfft's kf_factor,
+// kf_work and kf_bfly*, adapted to std::complex< double >:
+//
+// Copyright (c) 2003-2010, Mark Borgerding
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+// * Neither the author nor the names of any contributors may be used to
+//   endorse or promote products derived from this software without specific
+//   prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+///////////////////////////////////////////////////////////////////////////////
+
+// Mixed-radix DCT / DST for lengths that are not a power of two.
+//
+// The Ooura routines (fftsg.cpp) only take n = 2^k. Here every 1D
+// transform is mapped onto one complex FFT of the same length (Makhoul),
+// and the FFT is a recursive Cooley-Tukey over the factors of n:
+// radix-4/2/3 butterflies, and a generic one for 5 and larger primes.
+// Input / output conventions are those of ddct() / ddst().
+
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <cstring>
+
+#include "fft.h"
+
+typedef std::complex< double > cpx;
+
+#define MRDCT_MAX_FACTOR 32
+
+struct MRDCT_PLAN {
+  int n;
+  int maxRadix;
+  int factors[2 * MRDCT_MAX_FACTOR];  // (radix, remaining length) pairs
+  cpx *tw;                            // exp(-2 pi i k / n)
+  cpx *post;                          // exp(-i pi k / (2n))
+};
+
+static void MrFactor(MRDCT_PLAN *plan) {
+  int n = plan->n;
+  int p = 4;
+  int cnt = 0;
+  plan->maxRadix = 1;
+
+  while(n > 1) {
+    while(n % p) {
+      if(p == 4) {
+        p = 2;
+      }
+      else if(p == 2) {
+        p = 3;
+      }
+      else {
+        p += 2;
+      }
+      if(p * p > n) {
+        p = n;
+      }
+    }
+    n /= p;
+    plan->factors[2 * cnt] = p;
+    plan->factors[2 * cnt + 1] = n;
+    if(p > plan->maxRadix) {
+      plan->maxRadix = p;
+    }
+    cnt++;
+  }
+}
+
+MRDCT_PLAN *mrdct_plan_create(int n) {
+  MRDCT_PLAN *plan = (MRDCT_PLAN *)malloc(sizeof(MRDCT_PLAN));
+  plan->n = n;
+  MrFactor(plan);
+
+  plan->tw = new cpx[n];
+  plan->post = new cpx[n];
+  for(int k = 0; k < n; k++) {
+    plan->tw[k] = std::polar(1.0, (double)(-2.0 * PI * k / n));
+    plan->post[k] = std::polar(1.0, (double)(-PI * k / (2.0 * n)));
+  }
+  return plan;
+}
+
+void mrdct_plan_delete(MRDCT_PLAN *plan) {
+  if(!plan) {
+    return;
+  }
+  delete[] plan->tw;
+  delete[] plan->post;
+  free(plan);
+}
+
+// doubles of work area one call needs
+size_t mrdct_work_size(const MRDCT_PLAN *plan) {
+  return 2 * (2 * (size_t)plan->n + plan->maxRadix);
+}
+
+static void MrBfly2(cpx *f, int fstride, const MRDCT_PLAN *plan, int m) {
+  for(int k = 0; k < m; k++) {
+    cpx t = f[m + k] * plan->tw[k * fstride];
+    f[m + k] = f[k] - t;
+    f[k] += t;
+  }
+}
+
+static void MrBfly3(cpx *f, int fstride, const MRDCT_PLAN *plan, int m) {
+  double epi3 = plan->tw[fstride * m].imag();
+  for(int k = 0; k < m; k++) {
+    cpx s1 = f[m + k] * plan->tw[k * fstride];
+    cpx s2 = f[2 * m + k] * plan->tw[2 * k * fstride];
+    cpx s3 = s1 + s2;
+    cpx s0 = (s1 - s2) * epi3;
+    cpx h = f[k] - s3 * 0.5;
+    f[k] += s3;
+    f[2 * m + k] = cpx(h.real() + s0.imag(), h.imag() - s0.real());
+    f[m + k] = cpx(h.real() - s0.imag(), h.imag() + s0.real());
+  }
+}
+
+static void MrBfly4(cpx *f, int fstride, const MRDCT_PLAN *plan, int m) {
+  for(int k = 0; k < m; k++) {
+    cpx s0 = f[m + k] * plan->tw[k * fstride];
+    cpx s1 = f[2 * m + k] * plan->tw[2 * k * fstride];
+    cpx s2 = f[3 * m + k] * plan->tw[3 * k * fstride];
+    cpx s5 = f[k] - s1;
+    cpx f0 = f[k] + s1;
+    cpx s3 = s0 + s2;
+    cpx s4 = s0 - s2;
+    f[2 * m + k] = f0 - s3;
+    f[k] = f0 + s3;
+    f[m + k] = cpx(s5.real() + s4.imag(), s5.imag() - s4.real());
+    f[3 * m + k] = cpx(s5.real() - s4.imag(), s5.imag() + s4.real());
+  }
+}
+
+static void MrBflyGeneric(cpx *f, int fstride, const MRDCT_PLAN *plan, int p,
+                          int m, cpx *scratch) {
+  int n = plan->n;
+  for(int u = 0; u < m; u++) {
+    for(int q1 = 0, k = u; q1 < p; q1++, k += m) {
+      scratch[q1] = f[k];
+    }
+    for(int q1 = 0, k = u; q1 < p; q1++, k += m) {
+      int twIdx = 0;
+      f[k] = scratch[0];
+      for(int q = 1; q < p; q++) {
+        twIdx += fstride * k;
+        if(twIdx >= n) {
+          twIdx -= n;
+        }
+        f[k] += scratch[q] * plan->tw[twIdx];
+      }
+    }
+  }
+}
+
+static void MrWork(cpx *out, const cpx *in, int fstride, const int *factors,
+                   const MRDCT_PLAN *plan, cpx *scratch) {
+  int p = factors[0];
+  int m = factors[1];
+
+  if(m == 1) {
+    for(int j = 0; j < p; j++) {
+      out[j] = in[j * fstride];
+    }
+  }
+  else {
+    for(int j = 0; j < p; j++) {
+      MrWork(out + j * m, in + j * fstride, fstride * p, factors + 2, plan,
+             scratch);
+    }
+  }
+
+  switch(p) {
+    case 2:
+      MrBfly2(out, fstride, plan, m);
+      break;
+    case 3:
+      MrBfly3(out, fstride, plan, m);
+      break;
+    case 4:
+      MrBfly4(out, fstride, plan, m);
+      break;
+    default:
+      MrBflyGeneric(out, fstride, plan, p, m, scratch);
+      break;
+  }
+}
+
+// C[k] = sum_j a[j] cos(pi (j + 1/2) k / n)
+static void MrDctII(const MRDCT_PLAN *plan, prec *a, double *work) {
+  int n = plan->n;
+  cpx *v = (cpx *)work;
+  cpx *vf = v + n;
+  cpx *scratch = vf + n;
+
+  for(int j = 0; 2 * j < n; j++) {
+    v[j] = a[2 * j];
+  }
+  for(int j = 0; 2 * j + 1 < n; j++) {
+    v[n - 1 - j] = a[2 * j + 1];
+  }
+  MrWork(vf, v, 1, plan->factors, plan, scratch);
+  for(int k = 0; k < n; k++) {
+    a[k] = (vf[k] * plan->post[k]).real();
+  }
+}
+
+// C[k] = sum_j a[j] cos(pi j (k + 1/2) / n)
+static void MrDctIII(const MRDCT_PLAN *plan, prec *a, double *work) {
+  int n = plan->n;
+  cpx *v = (cpx *)work;
+  cpx *vf = v + n;
+  cpx *scratch = vf + n;
+
+  // V[j] = a[j] exp(i pi j / (2n)) through an inverse FFT, done as
+  // FFT(conj(V)) since only the real part is kept
+  for(int j = 0; j < n; j++) {
+    v[j] = plan->post[j] * (double)a[j];
+  }
+  MrWork(vf, v, 1, plan->factors, plan, scratch);
+  for(int m = 0; 2 * m < n; m++) {
+    a[2 * m] = vf[m].real();
+  }
+  for(int m = 0; 2 * m + 1 < n; m++) {
+    a[2 * m + 1] = vf[n - 1 - m].real();
+  }
+}
+
+void mrdct(const MRDCT_PLAN *plan, int isgn, prec *a, double *work) {
+  if(isgn < 0) {
+    MrDctII(plan, a, work);
+  }
+  else {
+    MrDctIII(plan, a, work);
+  }
+}
+
+// Both sine transforms reduce to the cosine ones by reversing the
+// frequency index and flipping the sign of every other sample.
+void mrdst(const MRDCT_PLAN *plan, int isgn, prec *a, double *work) {
+  int n = plan->n;
+
+  if(isgn < 0) {
+    for(int j = 1; j < n; j += 2) {
+      a[j] = -a[j];
+    }
+    MrDctII(plan, a, work);
+    // a[k] = S[k] = C[n - k] for 0 < k < n, a[0] = S[n] = C[0]
+    for(int k = 1; 2 * k < n; k++) {
+      prec t = a[k];
+      a[k] = a[n - k];
+      a[n - k] = t;
+    }
+  }
+  else {
+    // B[0] = A[n] (kept in a[0]), B[m] = A[n - m]
+    for(int k = 1; 2 * k < n; k++) {
+      prec t = a[k];
+      a[k] = a[n - k];
+      a[n - k] = t;
+    }
+    MrDctIII(plan, a, work);
+    for(int k = 1; k < n; k += 2) {
+      a[k] = -a[k];
+    }
+  }
+}
@@ -0,0 +1,266 @@
+///////////////////////////////////////////////////////////////////////////////
+// Authors: Ilgweon Kang and Lutong Wang
+//          (respective Ph.D. advisors: Chung-Kuan Cheng, Andrew B. Kahng),
+//          based on Dr. Jingwei Lu with ePlace and ePlace-MS
+//
+//          Many subsequent improvements were made by Mingyu Woo
+//          leading up to the initial release.
+//
+// BSD 3-Clause License
+//
+// Copyright (c) 2018, The Regents of the University of California
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Lane-parallel DCT / DST for power-of-two lengths.
+//
+// A 2D transform runs the same 1D transform on every row and column, so
+// the vector lanes carry DCTV_LANES independent lines: a[j] holds
+// element j of each line. Every line is mapped onto one complex FFT of
+// the same length (Makhoul, as in fftmr.cpp), done as an iterative
+// radix-4 DIT (pairs of radix-2 stages fused) over bit-reversed input.
+// Each butterfly works on whole vectors and each twiddle is one
+// broadcast, so the code is SIMD whatever the length. The entry points
+// are cloned per ISA and picked at load time; the kernels below inline
+// into each clone. Input / output conventions are those of ddct() /
+// ddst().
+
+#include <cmath>
+#include <cstdlib>
+
+#include "fft.h"
+#include "util.h"
+
+#if defined(__x86_64__) && defined(__linux__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define DCTV_CLONES __attribute__((target_clones("avx2", "default")))
+#endif
+#endif
+#ifndef DCTV_CLONES
+#define DCTV_CLONES
+#endif
+
+#define DCTV_INLINE static inline __attribute__((always_inline))
+
+struct DCTV_PLAN {
+  int n;
+  int logn;
+  int *rev;    // bit reversal of 0 .. n - 1
+  prec *twr;   // exp(-2 pi i k / n), k < n / 2
+  prec *twi;
+  prec *postr; // exp(-i pi k / (2n)), k < n
+  prec *posti;
+};
+
+DCTV_PLAN *dctv_plan_create(int n) {
+  DCTV_PLAN *plan = (DCTV_PLAN *)malloc(sizeof(DCTV_PLAN));
+  plan->n = n;
+  plan->logn = 0;
+  while((1 << plan->logn) < n) {
+    plan->logn++;
+  }
+
+  plan->rev = (int *)malloc(sizeof(int) * n);
+  for(int j = 0; j < n; j++) {
+    int r = 0;
+    for(int b = 0; b < plan->logn; b++) {
+      r |= ((j >> b) & 1) << (plan->logn - 1 - b);
+    }
+    plan->rev[j] = r;
+  }
+
+  plan->twr = AllocAlignedPrec(n / 2 + 1);
+  plan->twi = AllocAlignedPrec(n / 2 + 1);
+  for(int k = 0; k < n / 2; k++) {
+    plan->twr[k] = cos(2.0 * PI * k / n);
+    plan->twi[k] = -sin(2.0 * PI * k / n);
+  }
+  plan->postr = AllocAlignedPrec(n);
+  plan->posti = AllocAlignedPrec(n);
+  for(int k = 0; k < n; k++) {
+    plan->postr[k] = cos(PI * k / (2.0 * n));
+    plan->posti[k] = -sin(PI * k / (2.0 * n));
+  }
+  return plan;
+}
+
+void dctv_plan_delete(DCTV_PLAN *plan) {
+  if(!plan) {
+    return;
+  }
+  free(plan->rev);
+  free(plan->twr);
+  free(plan->twi);
+  free(plan->postr);
+  free(plan->posti);
+  free(plan);
+}
+
+// vectors of work area one call needs
+size_t dctv_work_size(const DCTV_PLAN *plan) {
+  return 2 * (size_t)plan->n;
+}
+
+// complex FFT of (re, im), already in bit-reversed order
+DCTV_INLINE void FftLanes(const DCTV_PLAN *plan, dctv_t *re, dctv_t *im) {
+  int n = plan->n;
+  int L = 4;
+
+  if(plan->logn & 1) {
+    for(int i = 0; i < n; i += 2) {
+      dctv_t tr = re[i + 1], ti = im[i + 1];
+      re[i + 1] = re[i] - tr;
+      im[i + 1] = im[i] - ti;
+      re[i] += tr;
+      im[i] += ti;
+    }
+    L = 8;
+  }
+
+  // stages L / 2 and L in one pass: x1, x3 with W_{L/2}^k, then x0 / x2
+  // with W_L^k and x1 / x3 with W_L^{k + L/4} = -i W_L^k
+  for(; L <= n; L *= 4) {
+    int q = L / 4;
+    int s = n / L;
+    for(int i = 0; i < n; i += L) {
+      for(int k = 0; k < q; k++) {
+        prec w1r = plan->twr[2 * k * s], w1i = plan->twi[2 * k * s];
+        prec w2r = plan->twr[k * s], w2i = plan->twi[k * s];
+        int i0 = i + k, i1 = i0 + q, i2 = i1 + q, i3 = i2 + q;
+
+        dctv_t tr = w1r * re[i1] - w1i * im[i1];
+        dctv_t ti = w1r * im[i1] + w1i * re[i1];
+        dctv_t b0r = re[i0] + tr, b0i = im[i0] + ti;
+        dctv_t b1r = re[i0] - tr, b1i = im[i0] - ti;
+
+        tr = w1r * re[i3] - w1i * im[i3];
+        ti = w1r * im[i3] + w1i * re[i3];
+        dctv_t b2r = re[i2] + tr, b2i = im[i2] + ti;
+        dctv_t b3r = re[i2] - tr, b3i = im[i2] - ti;
+
+        tr = w2r * b2r - w2i * b2i;
+        ti = w2r * b2i + w2i * b2r;
+        re[i0] = b0r + tr;
+        im[i0] = b0i + ti;
+        re[i2] = b0r - tr;
+        im[i2] = b0i - ti;
+
+        // -i (ur + i ui) = ui - i ur
+        tr = w2r * b3i + w2i * b3r;
+        ti = -(w2r * b3r - w2i * b3i);
+        re[i1] = b1r + tr;
+        im[i1] = b1i + ti;
+        re[i3] = b1r - tr;
+        im[i3] = b1i - ti;
+      }
+    }
+  }
+}
+
+// C[k] = sum_j a[j] cos(pi (j + 1/2) k / n)
+DCTV_INLINE void DctIILanes(const DCTV_PLAN *plan, dctv_t *a, dctv_t *work) {
+  int n = plan->n;
+  const int *rev = plan->rev;
+  dctv_t *re = work;
+  dctv_t *im = work + n;
+  dctv_t zero = {};
+
+  for(int j = 0; 2 * j < n; j++) {
+    re[rev[j]] = a[2 * j];
+    im[rev[j]] = zero;
+  }
+  for(int j = 0; 2 * j + 1 < n; j++) {
+    re[rev[n - 1 - j]] = a[2 * j + 1];
+    im[rev[n - 1 - j]] = zero;
+  }
+  FftLanes(plan, re, im);
+  for(int k = 0; k < n; k++) {
+    a[k] = plan->postr[k] * re[k] - plan->posti[k] * im[k];
+  }
+}
+
+// C[k] = sum_j a[j] cos(pi j (k + 1/2) / n)
+DCTV_INLINE void DctIIILanes(const DCTV_PLAN *plan, dctv_t *a, dctv_t *work) {
+  int n = plan->n;
+  const int *rev = plan->rev;
+  dctv_t *re = work;
+  dctv_t *im = work + n;
+
+  // V[j] = a[j] exp(i pi j / (2n)) through an inverse FFT, done as
+  // FFT(conj(V)) since only the real part is kept
+  for(int j = 0; j < n; j++) {
+    re[rev[j]] = plan->postr[j] * a[j];
+    im[rev[j]] = plan->posti[j] * a[j];
+  }
+  FftLanes(plan, re, im);
+  for(int m = 0; 2 * m < n; m++) {
+    a[2 * m] = re[m];
+  }
+  for(int m = 0; 2 * m + 1 < n; m++) {
+    a[2 * m + 1] = re[n - 1 - m];
+  }
+}
+
+DCTV_CLONES
+void dctv(const DCTV_PLAN *plan, int isgn, dctv_t *a, dctv_t *work) {
+  if(isgn < 0) {
+    DctIILanes(plan, a, work);
+  }
+  else {
+    DctIIILanes(plan, a, work);
+  }
+}
+
+// same index reversal and sign flips as mrdst()
+DCTV_CLONES
+void dstv(const DCTV_PLAN *plan, int isgn, dctv_t *a, dctv_t *work) {
+  int n = plan->n;
+
+  if(isgn < 0) {
+    for(int j = 1; j < n; j += 2) {
+      a[j] = -a[j];
+    }
+    DctIILanes(plan, a, work);
+    for(int k = 1; 2 * k < n; k++) {
+      dctv_t t = a[k];
+      a[k] = a[n - k];
+      a[n - k] = t;
+    }
+  }
+  else {
+    for(int k = 1; 2 * k < n; k++) {
+      dctv_t t = a[k];
+      a[k] = a[n - k];
+      a[n - k] = t;
+    }
+    DctIIILanes(plan, a, work);
+    for(int k = 1; k < n; k += 2) {
+      a[k] = -a[k];
+    }
+  }
+}
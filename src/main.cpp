@@ -53,6 +53,7 @@
 #include "lefdefIO.h"
 #include "bin.h"
 #include "charge.h"
+#include "checkpoint.h"
 #include "fft.h"
 #include "replace_private.h"
 #include "initPlacement.h"
@@ -233,9 +234,9 @@ prec target_cell_den;
 prec target_cell_den_orig;  // lutong
 prec total_macro_area;
 prec grad_stp;
-prec gsum_phi;
+prec_acc gsum_phi;
 prec gsum_ovfl;
-prec gsum_ovf_area;
+prec_acc gsum_ovf_area;
 prec overflowMin;
 prec mGP3D_opt_phi_cof;
 prec mGP2D_opt_phi_cof;
@@ -323,6 +324,8 @@ int numInitPlaceIter;
 prec refDeltaWL;
 
 int numThread;
+int wlenThread;  // share of numThread for the net pass (see -overlap)
+int binThread;   // share of numThread for the density pass
 InputMode inputMode;
 
 string benchName;
@@ -361,6 +364,16 @@ bool isOnlyLGinDP;
 bool isPlot;
 bool isSkipIP;
 bool isBinSet;
+bool isBinAuto;
+bool isWlenSimd;
+bool isWlenNetGrad;
+int highFanoutThres;
+int wlenModel;
+bool isDeterministic;
+bool isOverlapUpdate;
+int specStepCnt;
+int ckptIter;
+string resumeFile;
 bool isDummyFill;
 
 int conges_eval_methodCMD;
@@ -484,6 +497,10 @@ int main(int argc, char *argv[]) {
     PrintProcEnd("Initial Placement");
     ///////////////////////////////////////////////////////////////////////
 
+    if(trialRunCMD == true) {
+      place_snapshot_save();
+    }
+
     ///////////////////////////////////////////////////////////////////////
     ///// Setup before Placement Optimization  ////////////////////////////
     setup_before_opt();
@@ -497,12 +514,8 @@ int main(int argc, char *argv[]) {
       trial_main();
       time_end(&time_tp);
       ///////////////////////////////////////////////
-      free_trial_mallocs();
-      ParseInput();
-      build_data_struct();
-      net_update_init();
-      init_tier();
-      initialPlacement_main();
+      place_snapshot_restore();
+      place_snapshot_delete();
       setup_before_opt();
       ///////////////////////////////////////////////////////////////////////
       isTrial = false;
@@ -738,13 +751,14 @@ void init() {
   //
   // see: wlen.cpp: wcof_init function also
   //
-  switch(WLEN_MODEL) {
+  switch(wlenModel) {
     case LSE:
       // 10 !!!
       wcof00.x = wcof00.y = 0.1;
       break;
 
     case WA:
+    case STN:
       if(INPUT_FLG == ISPD05 || INPUT_FLG == ISPD06 || INPUT_FLG == ISPD ||
          INPUT_FLG == MMS || INPUT_FLG == SB || INPUT_FLG == ETC) {
 
@@ -867,7 +881,16 @@ void calcTSVweight() {
 
 void initialPlacement_main() {
   STAGE = INITIAL_PLACE;
-  initial_placement();
+  // with -resume, nesterov_opt() takes the positions from the checkpoint,
+  // but only if it was saved from the first GP stage after IP
+  int header[CKPT_H_CNT];
+  int firstStage = (placementMacroCNT > 0) ? mGP2D : cGP2D;
+  bool isResumeIP = !resumeFile.empty() &&
+                    ckpt_read_header(resumeFile, header) &&
+                    header[CKPT_H_STAGE] == firstStage;
+  if(!isResumeIP) {
+    initial_placement();
+  }
   UpdateNetAndGetHpwl();
 
   PrintUnscaledHpwl("Initial Placement");
@@ -1054,6 +1077,161 @@ void WriteBookshelf() {
   fflush(stdout);
 }
 
+// Post-IP snapshot restored after the trial run instead of re-parsing.
+// It covers what ParseInput() / IP set and the trial GP may change:
+//  - MODULE / TERM / PIN / TIER arrays, copied by value; their pin / pof
+//    arrays are shared, the trial only reads them
+//  - per net: the pin list, which cell_init() compacts, and the bounds
+//  - place, term_pmin / term_pmax, placementMacroCNT and the std / macro
+//    / placeable area totals
+// gcell_st, net->pin2, bins, the FFT grid and the place graph are
+// rebuilt by setup_before_opt(). Other globals (routability inflation,
+// trial step-size extreme points) are kept, as the re-parse kept them.
+struct NET_SNAPSHOT {
+  prec min_x;
+  prec min_y;
+  prec max_x;
+  prec max_y;
+  FPOS terminalMin;
+  FPOS terminalMax;
+  prec hpwl_x;
+  prec hpwl_y;
+  prec hpwl;
+  int pinStart;
+  int pinCNTinObject;
+};
+
+static MODULE *snapModule = NULL;
+static TERM *snapTerminal = NULL;
+static PIN *snapPin = NULL;
+static TIER *snapTier = NULL;
+static NET_SNAPSHOT *snapNet = NULL;
+static PIN **snapNetPin = NULL;
+static PLACE snapPlace;
+static FPOS snapTermPmin;
+static FPOS snapTermPmax;
+static size_t snapCellNameCnt = 0;
+static int snapMacroCnt = 0;
+static prec snapStdArea = 0;
+static prec snapMacroArea = 0;
+static prec snapPlArea = 0;
+
+void place_snapshot_save() {
+  place_snapshot_delete();
+
+  snapModule = (MODULE *)malloc(sizeof(MODULE) * moduleCNT);
+  snapTerminal = (TERM *)malloc(sizeof(TERM) * terminalCNT);
+  snapPin = (PIN *)malloc(sizeof(PIN) * pinCNT);
+  snapTier = (TIER *)malloc(sizeof(TIER) * numLayer);
+  memcpy(snapModule, moduleInstance, sizeof(MODULE) * moduleCNT);
+  memcpy(snapTerminal, terminalInstance, sizeof(TERM) * terminalCNT);
+  memcpy(snapPin, pinInstance, sizeof(PIN) * pinCNT);
+  memcpy(snapTier, tier_st, sizeof(TIER) * numLayer);
+
+  // NET holds std containers, so only the fields changed by
+  // cell_init() and the placers are kept
+  snapNet = (NET_SNAPSHOT *)malloc(sizeof(NET_SNAPSHOT) * netCNT);
+  int pinStart = 0;
+  for(int i = 0; i < netCNT; i++) {
+    pinStart += netInstance[i].pinCNTinObject;
+  }
+  snapNetPin = (PIN **)malloc(sizeof(PIN *) * pinStart);
+
+  pinStart = 0;
+  for(int i = 0; i < netCNT; i++) {
+    NET *net = &netInstance[i];
+    NET_SNAPSHOT *snap = &snapNet[i];
+    snap->min_x = net->min_x;
+    snap->min_y = net->min_y;
+    snap->max_x = net->max_x;
+    snap->max_y = net->max_y;
+    snap->terminalMin = net->terminalMin;
+    snap->terminalMax = net->terminalMax;
+    snap->hpwl_x = net->hpwl_x;
+    snap->hpwl_y = net->hpwl_y;
+    snap->hpwl = net->hpwl;
+    snap->pinStart = pinStart;
+    snap->pinCNTinObject = net->pinCNTinObject;
+    memcpy(&snapNetPin[pinStart], net->pin,
+           sizeof(PIN *) * net->pinCNTinObject);
+    pinStart += net->pinCNTinObject;
+  }
+
+  snapPlace = place;
+  snapTermPmin = term_pmin;
+  snapTermPmax = term_pmax;
+  snapCellNameCnt = cellNameStor.size();
+  snapMacroCnt = placementMacroCNT;
+  snapStdArea = total_std_area;
+  snapMacroArea = total_macro_area;
+  snapPlArea = total_PL_area;
+}
+
+// bring the database back to the post-IP state; setup_before_opt()
+// must be called afterwards to rebuild cells, bins and FFT grid
+void place_snapshot_restore() {
+  if(!snapModule) {
+    return;
+  }
+
+  for(int i = 0; i < netCNT; i++) {
+    NET *net = &netInstance[i];
+    NET_SNAPSHOT *snap = &snapNet[i];
+
+    // pin2 is re-allocated by cell_init()
+    free(net->pin2);
+    net->pin2 = NULL;
+    net->pinCNTinObject2 = 0;
+
+    net->min_x = snap->min_x;
+    net->min_y = snap->min_y;
+    net->max_x = snap->max_x;
+    net->max_y = snap->max_y;
+    net->terminalMin = snap->terminalMin;
+    net->terminalMax = snap->terminalMax;
+    net->hpwl_x = snap->hpwl_x;
+    net->hpwl_y = snap->hpwl_y;
+    net->hpwl = snap->hpwl;
+    net->pinCNTinObject = snap->pinCNTinObject;
+    memcpy(net->pin, &snapNetPin[snap->pinStart],
+           sizeof(PIN *) * snap->pinCNTinObject);
+  }
+
+  memcpy(moduleInstance, snapModule, sizeof(MODULE) * moduleCNT);
+  memcpy(terminalInstance, snapTerminal, sizeof(TERM) * terminalCNT);
+  memcpy(pinInstance, snapPin, sizeof(PIN) * pinCNT);
+  memcpy(tier_st, snapTier, sizeof(TIER) * numLayer);
+
+  place = snapPlace;
+  place_backup = snapPlace;
+  term_pmin = snapTermPmin;
+  term_pmax = snapTermPmax;
+  cellNameStor.resize(snapCellNameCnt);
+  placementMacroCNT = snapMacroCnt;
+  total_std_area = snapStdArea;
+  total_macro_area = snapMacroArea;
+  total_PL_area = snapPlArea;
+
+  // fillers included: gcell_cnt is still the trial's count
+  cell_delete();
+  gcell_st = NULL;
+}
+
+void place_snapshot_delete() {
+  free(snapModule);
+  free(snapTerminal);
+  free(snapPin);
+  free(snapTier);
+  free(snapNet);
+  free(snapNetPin);
+  snapModule = NULL;
+  snapTerminal = NULL;
+  snapPin = NULL;
+  snapTier = NULL;
+  snapNet = NULL;
+  snapNetPin = NULL;
+}
+
 void free_trial_mallocs() {
   free(moduleInstance);
   free(terminalInstance);
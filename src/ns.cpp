@@ -47,10 +47,13 @@
 #include <cstring>
 #include <ctime>
 #include <chrono>
+#include <utility>
+#include <omp.h>
 
 #include "bookShelfIO.h"
 #include "bin.h"
 #include "charge.h"
+#include "checkpoint.h"
 #include "replace_private.h"
 #include "ns.h"
 #include "opt.h"
@@ -61,6 +64,89 @@
 
 using std::make_pair;
 static int backtrack_cnt = 0;
+// step-size candidates evaluated / iterations run in this stage; a
+// -specStep round counts all of its candidates
+static int backtrack_tot_cnt = 0;
+static int backtrack_iter_cnt = 0;
+
+// one -specStep candidate: the step size it tries and private copies of
+// everything an evaluation at that step writes
+struct SPEC_CAND {
+  prec_acc alpha;
+  prec_acc alphaNew;
+  prec_acc lc;
+  FPOS *x0_st;
+  FPOS *y0_st;
+  FPOS *y0_dst;
+  FPOS *y0_wdst;
+  FPOS *y0_pdst;
+  prec_acc *sumBlk;
+  prec_acc posDis2;
+  prec_acc gradDis2;
+  prec_acc gradNorm2;
+  PLACE_GRAPH *graph;
+  BIN_CTX bin;
+  FPOS hpwl;
+};
+
+// net_update + bin_update on st. With -overlap, the net pass and the
+// density pipeline (scatter, FFT, field) only share the cell positions,
+// so after those are moved they run as two concurrent sections with a
+// split of the -t threads. The split follows the measured section times,
+// except under -det, where it stays at half and half.
+static void NetAndBinUpdate(FPOS *st) {
+  static int wlenShare = 0;
+
+  if(!isOverlapUpdate || numThread < 2) {
+    net_update(st);
+    bin_update();
+    return;
+  }
+  if(wlenShare < 1 || wlenShare >= numThread) {
+    wlenShare = numThread / 2;
+  }
+
+  net_update_cells(st);
+
+  double wlenTime = 0, binTime = 0;
+  wlenThread = wlenShare;
+  binThread = numThread - wlenShare;
+
+  // num_threads, not omp_set_num_threads: the later kernels of the
+  // iteration inherit this thread's team size
+  int maxLevels = omp_get_max_active_levels();
+  omp_set_max_active_levels(2);
+#pragma omp parallel sections num_threads(2) default(none) \
+    shared(st, wlenTime, binTime)
+  {
+#pragma omp section
+    {
+      double t0 = omp_get_wtime();
+      net_update(st, false);
+      wlenTime = omp_get_wtime() - t0;
+    }
+#pragma omp section
+    {
+      double t0 = omp_get_wtime();
+      bin_update();
+      binTime = omp_get_wtime() - t0;
+    }
+  }
+  omp_set_max_active_levels(maxLevels);
+  wlenThread = binThread = numThread;
+
+  if(isDeterministic) {
+    return;
+  }
+
+  // hand one thread to the slower section
+  if(wlenTime > OVERLAP_BALANCE_TOL * binTime && wlenShare < numThread - 1) {
+    wlenShare++;
+  }
+  else if(binTime > OVERLAP_BALANCE_TOL * wlenTime && wlenShare > 1) {
+    wlenShare--;
+  }
+}
 
 void myNesterov::nesterov_opt() {
   int last_iter = 0;
@@ -129,6 +215,14 @@ void myNesterov::nesterov_opt() {
 
   it->alpha00 = it0.alpha00;
 
+  resume_iter = 0;
+  minPotn = PREC_MAX;
+  temp_iter = 0;
+  if(!resumeFile.empty() && !isTrial) {
+    // a checkpoint of another stage leaves this one to run from scratch
+    LoadCheckpoint();
+  }
+
   if(isTrial) {
     initialOVFL = it->ovfl;
 
@@ -142,7 +236,9 @@ void myNesterov::nesterov_opt() {
   // if (dynamicStepCMD) NUM_ITER_FILLER_PLACE = 20;
   // else                NUM_ITER_FILLER_PLACE = 20;
 
+  SpecStepInit();
   last_iter = DoNesterovOptimization(TimingInst);
+  SpecStepDelete();
 
   SummarizeNesterovOpt(last_iter);
 
@@ -166,6 +262,7 @@ void myNesterov::nesterov_opt() {
     // for comparison
     //        TimingInst.ExecuteStaFirst(gbch, verilogCMD, libStor, sdcCMD);
   }
+  ckpt_wait();
   malloc_free();
 }
 
@@ -292,6 +389,9 @@ void myNesterov::InitializationCommonVar() {
 
   cellLambdaArr = (prec *)malloc(sizeof(prec) * N);
   pcofArr = (prec *)malloc(sizeof(prec) * 100);
+  sumBlk = (prec_acc *)malloc(sizeof(prec_acc) * 2 *
+                              ((N + NS_SUM_BLOCK - 1) / NS_SUM_BLOCK));
+  isFusedSum = false;
   // alphaArrCD  =(prec*)malloc(sizeof(prec)*100);
   // deltaArrCD  =(prec*)malloc(sizeof(prec)*100);
   // IK 05/08/17
@@ -539,18 +639,27 @@ void myNesterov::InitializationIter() {
 
 int myNesterov::DoNesterovOptimization(Timing::Timing &TimingInst) {
   int i;
-  prec minPotn = PREC_MAX;
-  temp_iter = 0;
   // int last_route_iter = -100;
   // int post_filler_route = 1;
 
   bool timeon = false;
   double time = 0.0f;
 
-  for(i = 0; i < max_iter; i++) {
+  // routability and timing keep state outside myNesterov (inflated cells,
+  // STA), which is not in the checkpoint
+  bool isCkpt = ckptIter > 0 && !isTrial && !isRoutability && !isTiming;
+
+  backtrack_tot_cnt = 0;
+  backtrack_iter_cnt = 0;
+
+  for(i = resume_iter; i < max_iter; i++) {
     if(timeon)
       time_start(&time);
 
+    if(isCkpt && i > resume_iter && i % ckptIter == 0) {
+      SaveCheckpoint(i);
+    }
+
     if(isTrial == false && isRoutability == true &&
        isRoutabilityInit == false) {
       routability_init();
@@ -637,86 +746,73 @@ int myNesterov::DoNesterovOptimization(Timing::Timing &TimingInst) {
       cout << "prev: " << time << endl;
     }
 
-    while(1) {
-      backtrack_cnt++;
-
-      if(timeon) {
-        time_start(&time);
-      };
-      int j = 0;
-#pragma omp parallel default(none) private(j) shared(gcell_st)
-      {
-        FPOS u, v;
-        FPOS half_desize;
-#pragma omp for
-        for(j = start_idx; j < end_idx; j++) {
-          FPOS half_densize = gcell_st[j].half_den_size;
-
-          u.x = y_st[j].x + alpha_pred * y_dst[j].x;
-          u.y = y_st[j].y + alpha_pred * y_dst[j].y;
-          // cout <<"dst = (" <<y_dst[j].x <<", " <<y_dst[j].y <<")"
-          // <<endl;
-
-          v.x = u.x + cof * (u.x - x_st[j].x);
-          v.y = u.y + cof * (u.y - x_st[j].y);
-
-          x0_st[j] = GetCoordiLayoutInside(u, half_densize);
-          // auto temp = y0_st[j];
-          y0_st[j] = GetCoordiLayoutInside(v, half_densize);
-          // if (temp.x == y0_st[j].x && temp.y == y0_st[j].y) ++cnt;
+    // -specStep evaluates the step sizes of a round concurrently
+    if(IsSpecStepIter()) {
+      SpecStepSearch();
+    }
+    else {
+      while(1) {
+        backtrack_cnt++;
+
+        if(timeon) {
+          time_start(&time);
+        };
+        UpdatePosition();
+        if(timeon) {
+          time_end(&time);
+          cout << "inner for: " << time << endl;
+          time_start(&time);
         }
-      }
-      if(timeon) {
-        time_end(&time);
-        cout << "inner for: " << time << endl;
-        time_start(&time);
-      }
-      // cout <<"cnt: " <<cnt <<endl;
+        // cout <<"cnt: " <<cnt <<endl;
 
-      net_update(y0_st);
-      if(timeon) {
-        time_end(&time);
-        cout << "net update: " << time << endl;
-        time_start(&time);
-      }
-
-      bin_update();  // igkang
-      if(timeon) {
-        time_end(&time);
-        cout << "bin update: " << time << endl;
-        time_start(&time);
-      }
+        NetAndBinUpdate(y0_st);  // igkang
+        if(timeon) {
+          time_end(&time);
+          cout << "net & bin update: " << time << endl;
+          time_start(&time);
+        }
 
-      // lutong
-      // if (stnCMD == true) {
-      //  //buildRMST(y0_st);
-      //  buildRSMT_FLUTE(y0_st);
-      //}
+        // lutong
+        // if (stnCMD == true) {
+        //  //buildRMST(y0_st);
+        //  buildRSMT_FLUTE(y0_st);
+        //}
 
-      getCostFuncGradient3(y0_dst, y0_wdst, y0_pdst, y0_pdstl, N,
-                           cellLambdaArr);
-      if(timeon) {
-        time_end(&time);
-        cout << "GetCost Grad: " << time << endl;
-        time_start(&time);
-      }
+        getCostFuncGradient3(y0_dst, y0_wdst, y0_pdst, y0_pdstl, N,
+                             cellLambdaArr);
+        if(timeon) {
+          time_end(&time);
+          cout << "GetCost Grad: " << time << endl;
+          time_start(&time);
+        }
 
-      get_lc(y_st, y_dst, y0_st, y0_dst, &it0, N);
-      if(timeon) {
-        time_end(&time);
-        cout << "get_lc : " << time << endl;
-        time_start(&time);
-      }
+        if(isFusedSum) {
+          // get_lc3 from the fused sums; the 1 / (2N) of get_dis cancels
+          UpdateGradSum();
+          it0.lc = sqrt(gradDis2 / posDis2);
+          it0.alpha00 = 1.0 / it0.lc;
+        }
+        else {
+          get_lc(y_st, y_dst, y0_st, y0_dst, &it0, N);
+        }
+        if(timeon) {
+          time_end(&time);
+          cout << "get_lc : " << time << endl;
+          time_start(&time);
+        }
 
-      alpha_new = it0.alpha00;
+        alpha_new = it0.alpha00;
 
-      if(alpha_new > alpha_pred * 0.95 || backtrack_cnt >= MAX_BKTRK_CNT) {
-        alpha_pred = alpha_new;
-        it->alpha00 = alpha_new;
-        break;
-      }
-      else {
-        alpha_pred = alpha_new;
+        if(alpha_new > alpha_pred * 0.95 || backtrack_cnt >= MAX_BKTRK_CNT) {
+          alpha_pred = alpha_new;
+          it->alpha00 = alpha_new;
+          backtrack_tot_cnt += backtrack_cnt;
+          backtrack_iter_cnt++;
+          break;
+        }
+        else {
+          alpha_pred = alpha_new;
+        }
       }
     }
 
@@ -905,6 +1001,7 @@ void myNesterov::malloc_free() {
   free(y0_pdstl);
   free(cellLambdaArr);
   free(pcofArr);
+  free(sumBlk);
   // free(alphaArrCD);
   // free(deltaArrCD);
 }
@@ -934,6 +1031,11 @@ void myNesterov::SummarizeNesterovOpt(int last_index) {
     cGP2D_tot_iter = last_index;
     cGP2D_opt_phi_cof = opt_phi_cof;
   }
+  if(backtrack_iter_cnt > 0) {
+    PrintInfoInt("Nesterov: NumStepEvals", backtrack_tot_cnt, 1);
+    PrintInfoPrec("Nesterov: StepEvalsPerIter",
+                  (prec)backtrack_tot_cnt / backtrack_iter_cnt, 1);
+  }
 
   cell_update(x_st, N_org);
 
@@ -967,9 +1069,14 @@ void getCostFuncGradient3(struct FPOS *dst, struct FPOS *wdst,
   }
 }
 
-void getCostFuncGradient2(struct FPOS *dst, struct FPOS *wdst,
-                          struct FPOS *pdst, struct FPOS *pdstl, int N,
-                          prec *cellLambdaArr) {
+// g and ctx are the net graph and density context to read; ctx is NULL
+// for the tier's own (bin_update) and set for a -specStep candidate,
+// which leaves cellLambdaArr alone (it only feeds the local terms)
+template < class WLEN >
+static void CostFuncGradient2(PLACE_GRAPH *g, BIN_CTX *ctx, struct FPOS *dst,
+                              struct FPOS *wdst, struct FPOS *pdst,
+                              struct FPOS *pdstl, int N,
+                              prec *cellLambdaArr) {
   //    bool timeon = true;
   //    double time = 0;
 
@@ -977,8 +1084,8 @@ void getCostFuncGradient2(struct FPOS *dst, struct FPOS *wdst,
 
   int i = 0;
 #pragma omp parallel default(none) private(i)                              \
-    shared(N, cellLambdaArr, gcell_st, dampParam, STAGE, pdstl, dst, wdst, \
-           pdst, MIN_PRE, constraintDrivenCMD, opt_phi_cof, lambda2CMD)
+    shared(g, ctx, N, cellLambdaArr, gcell_st, dampParam, STAGE, pdstl, dst, \
+           wdst, pdst, MIN_PRE, constraintDrivenCMD, opt_phi_cof, lambda2CMD)
   {
     CELL *cell = NULL;
     FPOS wgrad;
@@ -991,14 +1098,16 @@ void getCostFuncGradient2(struct FPOS *dst, struct FPOS *wdst,
 #pragma omp for
     for(i = 0; i < N; i++) {
       cell = &gcell_st[i];
-      cellLambdaArr[i] *= dampParam;
+      if(!ctx) {
+        cellLambdaArr[i] *= dampParam;
+      }
       if(cell->flg == Macro && (STAGE == cGP3D || STAGE == cGP2D)) {
         wgrad.SetZero();
         pgrad.SetZero();
         pgradl.SetZero();
       }
       else {
-        wlen_grad(i, &wgrad);
+        WlenGrad< WLEN >(g, i, &wgrad);
         if(STAGE == mGP2D) {
           if(constraintDrivenCMD == false) {
             potn_grad_2D(i, &pgrad);
@@ -1014,7 +1123,12 @@ void getCostFuncGradient2(struct FPOS *dst, struct FPOS *wdst,
         }
         else if(STAGE == cGP2D) {
           if(constraintDrivenCMD == false) {
-            potn_grad_2D(i, &pgrad);
+            if(ctx) {
+              potn_grad_2D_ctx(ctx, i, &pgrad);
+            }
+            else {
+              potn_grad_2D(i, &pgrad);
+            }
           }
           else if(constraintDrivenCMD == true) {
             // if (lambda2CMD == false) {
@@ -1063,9 +1177,12 @@ void getCostFuncGradient2(struct FPOS *dst, struct FPOS *wdst,
   //    if(timeon) { time_end(&time);cout << "!!: " << time << endl;}
   //    exit(1);
 }
-void getCostFuncGradient2_DEN_ONLY_PRECON(struct FPOS *dst, struct FPOS *wdst,
-                                          struct FPOS *pdst, struct FPOS *pdstl,
-                                          int N, prec *cellLambdaArr) {
+template < class WLEN >
+static void CostFuncGradient2_DEN_ONLY_PRECON(struct FPOS *dst,
+                                              struct FPOS *wdst,
+                                              struct FPOS *pdst,
+                                              struct FPOS *pdstl, int N,
+                                              prec *cellLambdaArr) {
   struct FPOS wgrad;
   struct FPOS pgrad;
   struct FPOS pgradl;
@@ -1083,7 +1200,7 @@ void getCostFuncGradient2_DEN_ONLY_PRECON(struct FPOS *dst, struct FPOS *wdst,
       pgradl.SetZero();
     }
     else {
-      wlen_grad(i, &wgrad);
+      WlenGrad< WLEN >(place_graph, i, &wgrad);
       if(STAGE == mGP2D) {
         if(constraintDrivenCMD == false)
           potn_grad_2D(i, &pgrad);
@@ -1144,6 +1261,63 @@ void getCostFuncGradient2_DEN_ONLY_PRECON(struct FPOS *dst, struct FPOS *wdst,
   }
 }
 
+// the wirelength model is dispatched once here; the per-cell loops above
+// are instantiated per WlenWA / WlenLSE / WlenSTN policy
+void getCostFuncGradient2(struct FPOS *dst, struct FPOS *wdst,
+                          struct FPOS *pdst, struct FPOS *pdstl, int N,
+                          prec *cellLambdaArr) {
+  switch(wlenModel) {
+    case LSE:
+      CostFuncGradient2< WlenLSE >(place_graph, NULL, dst, wdst, pdst, pdstl,
+                                   N, cellLambdaArr);
+      break;
+    case STN:
+      CostFuncGradient2< WlenSTN >(place_graph, NULL, dst, wdst, pdst, pdstl,
+                                   N, cellLambdaArr);
+      break;
+    default:
+      CostFuncGradient2< WlenWA >(place_graph, NULL, dst, wdst, pdst, pdstl,
+                                  N, cellLambdaArr);
+      break;
+  }
+}
+
+// getCostFuncGradient2 of a -specStep candidate (no local terms)
+static void CostFuncGradientCtx(PLACE_GRAPH *g, BIN_CTX *ctx,
+                                struct FPOS *dst, struct FPOS *wdst,
+                                struct FPOS *pdst, int N) {
+  switch(wlenModel) {
+    case LSE:
+      CostFuncGradient2< WlenLSE >(g, ctx, dst, wdst, pdst, NULL, N, NULL);
+      break;
+    case STN:
+      CostFuncGradient2< WlenSTN >(g, ctx, dst, wdst, pdst, NULL, N, NULL);
+      break;
+    default:
+      CostFuncGradient2< WlenWA >(g, ctx, dst, wdst, pdst, NULL, N, NULL);
+      break;
+  }
+}
+
+void getCostFuncGradient2_DEN_ONLY_PRECON(struct FPOS *dst, struct FPOS *wdst,
+                                          struct FPOS *pdst, struct FPOS *pdstl,
+                                          int N, prec *cellLambdaArr) {
+  switch(wlenModel) {
+    case LSE:
+      CostFuncGradient2_DEN_ONLY_PRECON< WlenLSE >(dst, wdst, pdst, pdstl, N,
+                                                   cellLambdaArr);
+      break;
+    case STN:
+      CostFuncGradient2_DEN_ONLY_PRECON< WlenSTN >(dst, wdst, pdst, pdstl, N,
+                                                   cellLambdaArr);
+      break;
+    default:
+      CostFuncGradient2_DEN_ONLY_PRECON< WlenWA >(dst, wdst, pdst, pdstl, N,
+                                                  cellLambdaArr);
+      break;
+  }
+}
+
 void getCostFuncGradient2_filler(struct FPOS *dst, struct FPOS *wdst,
                                  struct FPOS *pdst, struct FPOS *pdstl,
                                  int start_idx, int end_idx,
@@ -1318,6 +1492,366 @@ void myNesterov::z_init() {
 //  exit(1);
 }
 
+// new x0 / y0 positions over [start_idx, end_idx). Outside filler-only
+// iterations this is all of [0, N), and the same sweep sums |y - y0|^2
+// for get_lc and UpdateNesterovIter. Blocks of NS_SUM_BLOCK are summed in
+// parallel, then in block order, so the sum does not depend on -t.
+void myNesterov::UpdatePosition() {
+  isFusedSum = (!FILLER_PLACE && start_idx == 0 && end_idx == N);
+  posDis2 = UpdatePosition(alpha_pred, x0_st, y0_st, sumBlk, numThread);
+}
+
+// the same at step stepAlpha into x0 / y0; returns |y - y0|^2
+prec_acc myNesterov::UpdatePosition(prec_acc stepAlpha, struct FPOS *x0,
+                                    struct FPOS *y0, prec_acc *blk,
+                                    int threadCnt) {
+  int cnt = end_idx - start_idx;
+  int blkCnt = (cnt + NS_SUM_BLOCK - 1) / NS_SUM_BLOCK;
+  int b = 0;
+
+  omp_set_num_threads(threadCnt);
+#pragma omp parallel for default(none) \
+    shared(gcell_st, cnt, blkCnt, stepAlpha, x0, y0, blk) private(b)
+  for(b = 0; b < blkCnt; b++) {
+    int j1 = start_idx + std::min(cnt, (b + 1) * NS_SUM_BLOCK);
+    prec_acc dis = 0;
+    for(int j = start_idx + b * NS_SUM_BLOCK; j < j1; j++) {
+      FPOS half_densize = gcell_st[j].half_den_size;
+      FPOS u, v;
+
+      u.x = y_st[j].x + stepAlpha * y_dst[j].x;
+      u.y = y_st[j].y + stepAlpha * y_dst[j].y;
+
+      v.x = u.x + cof * (u.x - x_st[j].x);
+      v.y = u.y + cof * (u.y - x_st[j].y);
+
+      x0[j] = GetCoordiLayoutInside(u, half_densize);
+      y0[j] = GetCoordiLayoutInside(v, half_densize);
+
+      prec dx = y_st[j].x - y0[j].x;
+      prec dy = y_st[j].y - y0[j].y;
+      dis += (prec_acc)dx * dx + (prec_acc)dy * dy;
+    }
+    blk[b] = dis;
+  }
+
+  prec_acc sum = 0;
+  for(b = 0; b < blkCnt; b++) {
+    sum += blk[b];
+  }
+  return sum;
+}
+
+// |y_dst - y0_dst|^2 and |y0_dst|^2 over [0, N) in one sweep, after the
+// gradient at y0 (isFusedSum only)
+void myNesterov::UpdateGradSum() {
+  UpdateGradSum(y0_dst, sumBlk, numThread, &gradDis2, &gradNorm2);
+}
+
+// the same for the gradient dst0
+void myNesterov::UpdateGradSum(struct FPOS *dst0, prec_acc *blk,
+                               int threadCnt, prec_acc *dis2,
+                               prec_acc *norm2) {
+  int blkCnt = (N + NS_SUM_BLOCK - 1) / NS_SUM_BLOCK;
+  int b = 0;
+
+  omp_set_num_threads(threadCnt);
+#pragma omp parallel for default(none) shared(blkCnt, dst0, blk) private(b)
+  for(b = 0; b < blkCnt; b++) {
+    int j1 = std::min(N, (b + 1) * NS_SUM_BLOCK);
+    prec_acc dis = 0, norm = 0;
+    for(int j = b * NS_SUM_BLOCK; j < j1; j++) {
+      prec dx = y_dst[j].x - dst0[j].x;
+      prec dy = y_dst[j].y - dst0[j].y;
+      dis += (prec_acc)dx * dx + (prec_acc)dy * dy;
+      norm += (prec_acc)dst0[j].x * dst0[j].x +
+              (prec_acc)dst0[j].y * dst0[j].y;
+    }
+    blk[2 * b] = dis;
+    blk[2 * b + 1] = norm;
+  }
+
+  *dis2 = *norm2 = 0;
+  for(b = 0; b < blkCnt; b++) {
+    *dis2 += blk[2 * b];
+    *norm2 += blk[2 * b + 1];
+  }
+}
+
+// -specStep: one private candidate per step size. Only cGP2D runs them
+// (BIN_CTX covers its single density grid), and only with a thread
+// group of at least one per candidate.
+void myNesterov::SpecStepInit() {
+  specCand = NULL;
+  specCnt = 0;
+  specThread = 0;
+  if(specStepCnt < 2 || numThread < specStepCnt || STAGE != cGP2D ||
+     numLayer != 1) {
+    return;
+  }
+
+  specCnt = specStepCnt;
+  specThread = numThread / specCnt;
+  specCand = (SPEC_CAND *)malloc(sizeof(SPEC_CAND) * specCnt);
+
+  int blkCnt = (N + NS_SUM_BLOCK - 1) / NS_SUM_BLOCK;
+  for(int k = 0; k < specCnt; k++) {
+    SPEC_CAND *c = &specCand[k];
+    c->x0_st = (struct FPOS *)malloc(sizeof(struct FPOS) * N);
+    c->y0_st = (struct FPOS *)malloc(sizeof(struct FPOS) * N);
+    c->y0_dst = (struct FPOS *)malloc(sizeof(struct FPOS) * N);
+    c->y0_wdst = (struct FPOS *)malloc(sizeof(struct FPOS) * N);
+    c->y0_pdst = (struct FPOS *)malloc(sizeof(struct FPOS) * N);
+    c->sumBlk = (prec_acc *)malloc(sizeof(prec_acc) * 2 * blkCnt);
+    c->graph = place_graph_clone();
+    bin_ctx_init(&c->bin, specThread);
+  }
+}
+
+void myNesterov::SpecStepDelete() {
+  for(int k = 0; k < specCnt; k++) {
+    SPEC_CAND *c = &specCand[k];
+    free(c->x0_st);
+    free(c->y0_st);
+    free(c->y0_dst);
+    free(c->y0_wdst);
+    free(c->y0_pdst);
+    free(c->sumBlk);
+    place_graph_clone_delete(c->graph);
+    bin_ctx_delete(&c->bin);
+  }
+  free(specCand);
+  specCand = NULL;
+  specCnt = 0;
+}
+
+// full-range iterations without the local-density terms; the others
+// keep the sequential backtracking loop
+bool myNesterov::IsSpecStepIter() {
+  return specCnt > 1 && !FILLER_PLACE && start_idx == 0 && end_idx == N &&
+         !constraintDrivenCMD && !lambda2CMD && !DEN_ONLY_PRECON;
+}
+
+// the backtracking loop of DoNesterovOptimization, specCnt step sizes
+// at a time: candidate k tries alpha_pred / 2^k on its own group of
+// specThread threads. The first candidate (largest step) passing the
+// 0.95 test is adopted; if none does, the round's smallest step sets
+// alpha_pred for the next round, as a failed backtrack would.
+void myNesterov::SpecStepSearch() {
+  SPEC_CAND *accept = NULL;
+  int k = 0;
+
+  bin_split_cells(&tier_st[0]);
+
+  int maxLevels = omp_get_max_active_levels();
+  omp_set_max_active_levels(2);
+  wlenThread = binThread = specThread;
+
+  while(!accept) {
+    backtrack_cnt += specCnt;
+
+    prec_acc stepAlpha = alpha_pred;
+    for(k = 0; k < specCnt; k++, stepAlpha *= 0.5) {
+      specCand[k].alpha = stepAlpha;
+    }
+
+#pragma omp parallel for num_threads(specCnt) schedule(static, 1) \
+    default(none) private(k)
+    for(k = 0; k < specCnt; k++) {
+      SpecStepEval(&specCand[k]);
+    }
+
+    for(k = 0; k < specCnt && !accept; k++) {
+      if(specCand[k].alphaNew > specCand[k].alpha * 0.95) {
+        accept = &specCand[k];
+      }
+    }
+    if(!accept && backtrack_cnt >= MAX_BKTRK_CNT) {
+      accept = &specCand[specCnt - 1];
+    }
+    alpha_pred = specCand[specCnt - 1].alphaNew;
+  }
+
+  omp_set_max_active_levels(maxLevels);
+  wlenThread = binThread = numThread;
+
+  SpecStepAdopt(accept);
+
+  alpha_new = accept->alphaNew;
+  alpha_pred = alpha_new;
+  it->alpha00 = alpha_new;
+  backtrack_tot_cnt += backtrack_cnt;
+  backtrack_iter_cnt++;
+}
+
+// UpdatePosition, net / bin update and the cost gradient at c->alpha,
+// touching only c's buffers, graph and density context
+void myNesterov::SpecStepEval(SPEC_CAND *c) {
+  c->posDis2 =
+      UpdatePosition(c->alpha, c->x0_st, c->y0_st, c->sumBlk, specThread);
+
+  c->hpwl = net_update_graph(c->graph, c->y0_st);
+  bin_update_ctx(&c->bin, c->y0_st);
+
+  omp_set_num_threads(specThread);
+  CostFuncGradientCtx(c->graph, &c->bin, c->y0_dst, c->y0_wdst, c->y0_pdst,
+                      N);
+
+  UpdateGradSum(c->y0_dst, c->sumBlk, specThread, &c->gradDis2,
+                &c->gradNorm2);
+  c->lc = sqrt(c->gradDis2 / c->posDis2);
+  c->alphaNew = 1.0 / c->lc;
+}
+
+// leave the state a sequential backtrack ending at c would have left:
+// c's buffers become x0_st / y0_*, the cells move to y0_st and the net
+// graph and density are c's
+void myNesterov::SpecStepAdopt(SPEC_CAND *c) {
+  std::swap(x0_st, c->x0_st);
+  std::swap(y0_st, c->y0_st);
+  std::swap(y0_dst, c->y0_dst);
+  std::swap(y0_wdst, c->y0_wdst);
+  std::swap(y0_pdst, c->y0_pdst);
+
+  isFusedSum = true;
+  posDis2 = c->posDis2;
+  gradDis2 = c->gradDis2;
+  gradNorm2 = c->gradNorm2;
+  it0.lc = c->lc;
+  it0.alpha00 = c->alphaNew;
+
+  net_update_cells(y0_st);
+  place_graph_adopt(c->graph);
+  total_hpwl = c->hpwl;
+  bin_ctx_adopt(&c->bin);
+}
+
+static string GetCheckpointName(void) {
+  return string(dir_bnd) + "/" + gbch + "_gp.ckpt";
+}
+
+template < class T >
+static bool CkptField(CKPT_BUF *buf, bool isLoad, T *val, size_t cnt = 1) {
+  if(isLoad) {
+    return ckpt_get(buf, val, sizeof(T) * cnt);
+  }
+  ckpt_put(buf, val, sizeof(T) * cnt);
+  return true;
+}
+
+// everything DoNesterovOptimization carries from one iteration to the
+// next. Save and load share this list; bump CKPT_VERSION when it changes.
+// The filler positions are the tail [moduleCNT, N) of the position
+// arrays.
+bool myNesterov::CheckpointFields(CKPT_BUF *buf, bool isLoad) {
+  struct FPOS *posArr[] = {x_st,    y_st,     z_st,    y_dst,   y_wdst,
+                           y_pdst,  y_pdstl,  z_dst,   z_wdst,  z_pdst,
+                           z_pdstl, x0_st,    y0_st,   y0_dst,  y0_wdst,
+                           y0_pdst, y0_pdstl};
+  bool isOk = true;
+  for(size_t k = 0; k < sizeof(posArr) / sizeof(posArr[0]); k++) {
+    isOk = isOk && CkptField(buf, isLoad, posArr[k], N);
+  }
+  isOk = isOk && CkptField(buf, isLoad, iter_st, max_iter + 1);
+  isOk = isOk && CkptField(buf, isLoad, &it0);
+  isOk = isOk && CkptField(buf, isLoad, cellLambdaArr, N);
+  isOk = isOk && CkptField(buf, isLoad, pcofArr, 100);
+
+  isOk = isOk && CkptField(buf, isLoad, &a);
+  isOk = isOk && CkptField(buf, isLoad, &ab);
+  isOk = isOk && CkptField(buf, isLoad, &alpha);
+  isOk = isOk && CkptField(buf, isLoad, &cof);
+  isOk = isOk && CkptField(buf, isLoad, &alpha_pred);
+  isOk = isOk && CkptField(buf, isLoad, &alpha_new);
+  isOk = isOk && CkptField(buf, isLoad, &sum_wgrad);
+  isOk = isOk && CkptField(buf, isLoad, &sum_pgrad);
+  isOk = isOk && CkptField(buf, isLoad, &sum_tgrad);
+  isOk = isOk && CkptField(buf, isLoad, &initialOVFL);
+  isOk = isOk && CkptField(buf, isLoad, &before100iter_cof);
+  isOk = isOk && CkptField(buf, isLoad, &before100iter_alpha);
+  isOk = isOk && CkptField(buf, isLoad, &before100iter_delta);
+  isOk = isOk && CkptField(buf, isLoad, &post_filler);
+  isOk = isOk && CkptField(buf, isLoad, &start_idx);
+  isOk = isOk && CkptField(buf, isLoad, &end_idx);
+  isOk = isOk && CkptField(buf, isLoad, &last_ra_iter);
+  isOk = isOk && CkptField(buf, isLoad, &temp_iter);
+  isOk = isOk && CkptField(buf, isLoad, &minPotn);
+
+  isOk = isOk && CkptField(buf, isLoad, &opt_phi_cof);
+  isOk = isOk && CkptField(buf, isLoad, &opt_phi_cof_local);
+  isOk = isOk && CkptField(buf, isLoad, &opt_w_cof);
+  isOk = isOk && CkptField(buf, isLoad, &UPPER_PCOF);
+  isOk = isOk && CkptField(buf, isLoad, &LOWER_PCOF);
+  isOk = isOk && CkptField(buf, isLoad, &potnPhaseDS);
+  isOk = isOk && CkptField(buf, isLoad, &ALPHA);
+  isOk = isOk && CkptField(buf, isLoad, &BETA);
+  isOk = isOk && CkptField(buf, isLoad, &wlen_cof);
+  isOk = isOk && CkptField(buf, isLoad, &wlen_cof_inv);
+  return isOk;
+}
+
+// snapshot the state at the top of iteration iter. Only the copy into
+// the buffer runs here; the file is written in the background.
+void myNesterov::SaveCheckpoint(int iter) {
+  static CKPT_BUF buf;
+  char magic[8] = CKPT_MAGIC;
+  int header[CKPT_H_CNT];
+  header[CKPT_H_VERSION] = CKPT_VERSION;
+  header[CKPT_H_PREC] = sizeof(prec);
+  header[CKPT_H_PREC_ACC] = sizeof(prec_acc);
+  header[CKPT_H_STAGE] = STAGE;
+  header[CKPT_H_N] = N;
+  header[CKPT_H_MAX_ITER] = max_iter;
+  header[CKPT_H_ITER] = iter;
+
+  buf.data.reserve(sizeof(FPOS) * 20 * N + sizeof(ITER) * (max_iter + 1));
+  ckpt_put(&buf, magic, sizeof(magic));
+  ckpt_put(&buf, header, sizeof(header));
+  CheckpointFields(&buf, false);
+  ckpt_write_async(&buf, GetCheckpointName());
+  PrintInfoInt("Nesterov: Checkpoint", iter, 1);
+}
+
+// false when the checkpoint was saved from another stage. After a load,
+// resumeFile is cleared, so later stages / calls start normally.
+bool myNesterov::LoadCheckpoint(void) {
+  CKPT_BUF buf;
+  if(!ckpt_read(&buf, resumeFile)) {
+    PrintError("Cannot read checkpoint " + resumeFile);
+  }
+  if(isRoutability || isTiming) {
+    PrintError("-resume does not support routability / timing-driven runs");
+  }
+
+  char magic[8];
+  int header[CKPT_H_CNT];
+  if(!ckpt_get(&buf, magic, sizeof(magic)) ||
+     strncmp(magic, CKPT_MAGIC, sizeof(magic)) != 0 ||
+     !ckpt_get(&buf, header, sizeof(header))) {
+    PrintError(resumeFile + " is not a checkpoint");
+  }
+  if(header[CKPT_H_VERSION] != CKPT_VERSION ||
+     header[CKPT_H_PREC] != (int)sizeof(prec) ||
+     header[CKPT_H_PREC_ACC] != (int)sizeof(prec_acc)) {
+    PrintError(resumeFile + ": checkpoint version / precision mismatch");
+  }
+  if(header[CKPT_H_STAGE] != STAGE) {
+    return false;
+  }
+  if(header[CKPT_H_N] != N || header[CKPT_H_MAX_ITER] != max_iter) {
+    PrintError(resumeFile + ": checkpoint is for another design");
+  }
+  if(!CheckpointFields(&buf, true)) {
+    PrintError(resumeFile + ": truncated checkpoint");
+  }
+
+  resume_iter = header[CKPT_H_ITER];
+  it = &iter_st[resume_iter];
+  PrintInfoInt("Nesterov: ResumeIter", resume_iter, 1);
+  resumeFile = "";
+  return true;
+}
+
 void myNesterov::UpdateNesterovOptStatus() {
   std::swap(z_st, y_st);
   std::swap(z_dst, y_dst);
@@ -1349,10 +1883,19 @@ void myNesterov::UpdateNesterovOptStatus() {
 
 void myNesterov::UpdateNesterovIter(int iter, struct ITER *it,
                                     struct ITER *last_it) {
-  it->grad = get_norm(y_dst, N, 2.0);
+  // after UpdateNesterovOptStatus, y_dst / y_st / z_st are the accepted
+  // y0_dst / y0_st and the previous y_st: the fused sums of the last
+  // backtracking step, normalized as in get_norm / get_dis
+  if(isFusedSum) {
+    it->grad = sqrt(gradNorm2 / (2.0 * N));
+    it->dis00 = sqrt(posDis2 / ((flg_3dic == 1 ? 3.0 : 2.0) * N));
+  }
+  else {
+    it->grad = get_norm(y_dst, N, 2.0);
+    it->dis00 = get_dis(z_st, y_st, N);
+  }
   it->potn = gsum_phi;
   it->ovfl = gsum_ovfl;
-  it->dis00 = get_dis(z_st, y_st, N);
   it->wcof = get_wlen_cof(it->ovfl);
   wlen_cof = fp_mul(base_wcof, it->wcof);
   wlen_cof_inv = fp_inv(wlen_cof);
@@ -1490,10 +2033,10 @@ void get_lc3_filler(struct FPOS *y_st, struct FPOS *y_dst, struct FPOS *z_st,
 // y_wdst and y_pdst
 // y_wdst : wirelength-gradient value
 // y_pdst : density-gradient value
-void myNesterov::InitializationCostFunctionGradient(prec *sum_wgrad0,
-                                                    prec *sum_pgrad0) {
-  prec tmp_sum_wgrad = 0;
-  prec tmp_sum_pgrad = 0;
+void myNesterov::InitializationCostFunctionGradient(prec_acc *sum_wgrad0,
+                                                    prec_acc *sum_pgrad0) {
+  prec_acc tmp_sum_wgrad = 0;
+  prec_acc tmp_sum_pgrad = 0;
   struct FPOS wgrad;
   struct FPOS pgrad;
   struct FPOS pgradl;
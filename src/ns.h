@@ -45,6 +45,11 @@
 #include "opt.h"
 #include "timing.h"
 
+// block size of the fixed-order sums in the fused Nesterov sweeps
+#define NS_SUM_BLOCK 4096
+
+struct SPEC_CAND;
+
 class myNesterov {
  private:
   struct FPOS *x_st;
@@ -83,25 +88,41 @@ class myNesterov {
   int start_idx;
   int end_idx;
   int post_filler;
-  prec sum_wgrad;
-  prec sum_pgrad;
-  prec sum_tgrad;
+  // Nesterov scalar state accumulates in prec_acc (double under IS_MIXED)
+  prec_acc sum_wgrad;
+  prec_acc sum_pgrad;
+  prec_acc sum_tgrad;
   int max_iter;
   int N;
   int N_org;
   int last_ra_iter;
-  prec a;
-  prec ab;
-  prec alpha;
-  prec cof;
+  prec_acc a;
+  prec_acc ab;
+  prec_acc alpha;
+  prec_acc cof;
   prec initialOVFL;
-  prec alpha_pred;
-  prec alpha_new;
+  prec_acc alpha_pred;
+  prec_acc alpha_new;
   prec before100iter_cof;
   prec before100iter_alpha;
   prec before100iter_delta;
 
+  // squared-distance sums of the fused sweeps (UpdatePosition and
+  // UpdateGradSum) over [0, N); valid only while isFusedSum
+  prec_acc *sumBlk;
+  prec_acc posDis2;    // |y - y0|^2
+  prec_acc gradDis2;   // |y_dst - y0_dst|^2
+  prec_acc gradNorm2;  // |y0_dst|^2
+  bool isFusedSum;
+
+  // -specStep candidates (see SpecStepSearch); specCnt = 0 when off
+  struct SPEC_CAND *specCand;
+  int specCnt;
+  int specThread;  // threads per candidate
+
   int temp_iter;
+  prec minPotn;
+  int resume_iter;  // first DoNesterovOptimization iteration
   std::vector<pair<int, bool> > timingChkArr;
   bool isTimingIter(int ovlp);
 
@@ -112,12 +133,27 @@ class myNesterov {
   void InitializationPrecondition(void);
   void InitializationPrecondition_DEN_ONLY_PRECON(void);
   void InitializationIter(void);
-  void InitializationCostFunctionGradient(prec *, prec *);
+  void InitializationCostFunctionGradient(prec_acc *, prec_acc *);
   int DoNesterovOptimization(Timing::Timing &TimingInst);
   void malloc_free(void);
   void SummarizeNesterovOpt(int last_index);
   void UpdateNesterovOptStatus(void);
   void UpdateNesterovIter(int iter, struct ITER *it, struct ITER *last_it);
+  void UpdatePosition(void);
+  prec_acc UpdatePosition(prec_acc stepAlpha, struct FPOS *x0,
+                          struct FPOS *y0, prec_acc *blk, int threadCnt);
+  void UpdateGradSum(void);
+  void UpdateGradSum(struct FPOS *dst0, prec_acc *blk, int threadCnt,
+                     prec_acc *dis2, prec_acc *norm2);
+  void SpecStepInit(void);
+  void SpecStepDelete(void);
+  bool IsSpecStepIter(void);
+  void SpecStepSearch(void);
+  void SpecStepEval(struct SPEC_CAND *c);
+  void SpecStepAdopt(struct SPEC_CAND *c);
+  bool CheckpointFields(struct CKPT_BUF *buf, bool isLoad);
+  void SaveCheckpoint(int iter);
+  bool LoadCheckpoint(void);
   void ShiftPL_SA(struct FPOS *y_st, int N);
   void ShiftPL_SA_sub(struct FPOS *y_st, int N);
   void z_init(void);
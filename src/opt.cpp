@@ -101,6 +101,8 @@ void setup_before_opt(void) {
   charge_fft_init(msh, bin_stp, 1);
 //  update_cell_den();
   wcof_init(bin_stp);
+
+  place_graph_build();
 }
 
 int setup_before_opt_mGP2D(void) {
@@ -108,6 +110,7 @@ int setup_before_opt_mGP2D(void) {
   bin_init_2D(mGP2D);
 
   charge_fft_init(dim_bin_mGP2D, bin_stp_mGP2D, 0);
+  bin_attach_fft_2D();
   wcof_init(bin_stp_mGP2D);
   wlen_init();
   cell_init_2D();
@@ -136,6 +139,7 @@ int setup_before_opt_cGP2D(void) {
   }
 
   charge_fft_init(dim_bin_cGP2D, bin_stp_cGP2D, 0);
+  bin_attach_fft_2D();
   wcof_init(bin_stp_cGP2D);
   wlen_init();
   cell_init_2D();
@@ -188,7 +192,7 @@ void cell_update(FPOS *st, int n) {
 //}
 
 prec get_norm(struct FPOS *st, int n, prec num) {
-  prec sum = 0;
+  prec_acc sum = 0;
   prec tmp = 0.0;
   for(int i = 0; i < n; i++) {
     sum += pow(fabs(st[i].x), num) + pow(fabs(st[i].y), num);
@@ -624,7 +628,7 @@ void UpdateGcellCoordiFromModule(void) {
 }
 
 prec get_dis(struct FPOS *a, struct FPOS *b, int N) {
-  prec sum_dis = 0;
+  prec_acc sum_dis = 0;
   prec tmp = 0.5;
 
   for(int i = 0; i < N; i++) {
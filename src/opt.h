@@ -264,6 +264,13 @@ void cell_init_2D(void);
 
 #define MAX_BKTRK_CNT 10
 
+// -overlap: section time ratio that moves a thread between net and bin
+#define OVERLAP_BALANCE_TOL 1.1
+
+// -specStep: most concurrent step-size candidates; candidate k tries
+// alpha_pred / 2^k
+#define SPEC_STEP_MAX_CNT 3
+
 #define tot_num_iter_var_pl 0
 
 //#define INIT_LAMBDA_COF_GP 0.0001
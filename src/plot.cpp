@@ -307,6 +307,7 @@ void DrawModule(CImgObj &img, const unsigned char color[], float opacity) {
 }
 
 void DrawBinDensity(CImgObj &img, float opacity) {
+  bin_update_mat_from_grid(&tier_st[0]);
   for(int i = 0; i < tier_st[0].tot_bin_cnt; i++) {
     BIN *curBin = &tier_st[0].bin_mat[i];
     int x1 = pe.GetX(curBin->pmin);
@@ -386,6 +387,7 @@ void CimgDrawArrow(CImgObj &img, int x1, int y1, int x3, int y3, int thick,
 }
 
 void DrawArrowDensity(CImgObj &img, float opacity) {
+  bin_update_mat_from_grid(&tier_st[0]);
   int binMaxX = (STAGE == cGP2D) ? dim_bin_cGP2D.x
                                  : (STAGE == mGP2D) ? dim_bin_mGP2D.x : INT_MIN;
   int binMaxY = (STAGE == cGP2D) ? dim_bin_cGP2D.y
@@ -85,6 +85,10 @@ replace_external::help() {
   cout << "    Set bin_grid_count. [64,128,256,512,..., int]. " << endl;
   cout << "    Default: Defined by internal algorithm." << endl;
   cout << endl; 
+  cout << "set_bin_auto_enable [true/false]" << endl;
+  cout << "    Pick a rectangular 2/3/5-smooth bin grid by FFT cost." << endl;
+  cout << "    (Ignored with set_number_of_bin_grids). Default: False" << endl;
+  cout << endl; 
   cout << "set_lambda [lambda]" << endl;
   cout << "    Set lambda for RePlAce tunning. [float]." << endl;
   cout << "    Default : 8e-5~10e5" << endl;
@@ -116,6 +120,55 @@ replace_external::help() {
   cout << "    Set net_weight_scale. [200-, float]" << endl;
   cout << endl; 
   
+  cout << "==== Wirelength options ==== " << endl;
+  cout << "set_wirelength_model [wa/lse/stn]" << endl;
+  cout << "    Wirelength model; stn is Steiner-scaled WA and needs" << endl;
+  cout << "    POWV9.dat / PORT9.dat in the working directory." << endl;
+  cout << "    Default: wa" << endl;
+  cout << endl; 
+  cout << "set_high_fanout_threshold [fanout]" << endl;
+  cout << "    Approximate WA of nets above this fanout by the pins" << endl;
+  cout << "    nearest each bbox side. Default: 0 (off)" << endl;
+  cout << endl; 
+  cout << "set_wlen_simd_enable [true/false]" << endl;
+  cout << "    Vectorized WA kernel with an accurate exp" << endl;
+  cout << "    (instead of the fastExp table). Default: False" << endl;
+  cout << endl; 
+  cout << "set_wlen_net_grad_enable [true/false]" << endl;
+  cout << "    Emit WA pin gradients in the net pass and reduce them" << endl;
+  cout << "    per cell. Default: False" << endl;
+  cout << endl; 
+
+  cout << "==== Parallel options ==== " << endl;
+  cout << "set_number_of_threads [count]" << endl;
+  cout << "    Number of OpenMP threads for global placement. Default: 1" << endl;
+  cout << endl; 
+  cout << "set_deterministic [true/false]" << endl;
+  cout << "    Make the placement independent of the thread count" << endl;
+  cout << "    (fixed density scatter parts, FFTW by estimate)." << endl;
+  cout << "    Default: False" << endl;
+  cout << endl; 
+  cout << "set_overlap_update [true/false]" << endl;
+  cout << "    Run the net update and the density update concurrently," << endl;
+  cout << "    splitting the threads between them. Default: False" << endl;
+  cout << endl; 
+  cout << "set_spec_step [count]" << endl;
+  cout << "    Try this many Nesterov step sizes (2 or 3) concurrently" << endl;
+  cout << "    and keep the first that passes the backtracking test." << endl;
+  cout << "    (cGP2D only, needs at least [count] threads). " << endl;
+  cout << "    Default: 0 (off)" << endl;
+  cout << endl; 
+
+  cout << "==== Checkpoint options ==== " << endl;
+  cout << "set_checkpoint_interval [iter_count]" << endl;
+  cout << "    Save a Nesterov checkpoint every [iter_count] iterations" << endl;
+  cout << "    (<output dir>/<design>_gp.ckpt). Default: 0 (off)" << endl;
+  cout << endl; 
+  cout << "set_resume_file [file_name]" << endl;
+  cout << "    Resume the Nesterov stage saved in *.ckpt. " << endl;
+  cout << "    Set before place_cell_init_place." << endl;
+  cout << endl; 
+
   cout << "==== Other options ==== " << endl;
   cout << "set_plot_enable [mode]" << endl;
   cout << "    Set plot modes; " << endl;
@@ -132,6 +185,10 @@ replace_external::help() {
   cout << "    Please do NOT use this command in general purposes" << endl;
   cout << "    (It'll not spread all cells enough). Default: False" << endl;
   cout << endl; 
+  cout << "set_trial_run_enable [true/false]" << endl;
+  cout << "    Run a trial global place first to catch the parameters," << endl;
+  cout << "    then restart from the initial placement. Default: False" << endl;
+  cout << endl; 
   cout << "set_verbose_level [level]" << endl;
   cout << "    Specify the verbose level. [1-3, int]. Default: 1" << endl;
   cout << endl; 
@@ -256,6 +313,11 @@ replace_external::set_seed_init_enable(bool seed_init) {
   isInitSeed = seed_init;
 }
 
+void
+replace_external::set_trial_run_enable(bool trial_run) {
+  trialRunCMD = trial_run;
+}
+
 
 void
 replace_external::set_plot_color_file(std::string color_file) {
@@ -278,6 +340,11 @@ replace_external::set_number_of_bin_grids(size_t grid_count) {
   isBinSet = true;
 }
 
+void
+replace_external::set_bin_auto_enable(bool mode) {
+  isBinAuto = mode;
+}
+
 void
 replace_external::set_lambda(double lambda) {
   INIT_LAMBDA_COF_GP = lambda; 
@@ -323,6 +390,74 @@ replace_external::set_net_weight_scale(double net_weight_scale) {
   netWeightScale = net_weight_scale;
 }
 
+void
+replace_external::set_wirelength_model(const char* model) {
+  if( !strcmp(model, "wa") ) {
+    wlenModel = WA;
+  }
+  else if( !strcmp(model, "lse") ) {
+    wlenModel = LSE;
+  }
+  else if( !strcmp(model, "stn") ) {
+    wlenModel = STN;
+  }
+  else {
+    cout << "ERROR: set_wirelength_model takes wa, lse or stn!" << endl;
+    exit(1);
+  }
+}
+
+void
+replace_external::set_high_fanout_threshold(int fanout) {
+  highFanoutThres = (fanout < 0)? 0 : fanout;
+}
+
+void
+replace_external::set_wlen_simd_enable(bool mode) {
+  isWlenSimd = mode;
+}
+
+void
+replace_external::set_wlen_net_grad_enable(bool mode) {
+  isWlenNetGrad = mode;
+}
+
+void
+replace_external::set_number_of_threads(int thread_count) {
+  numThread = (thread_count < 1)? 1 : thread_count;
+  wlenThread = binThread = numThread;
+}
+
+void
+replace_external::set_deterministic(bool mode) {
+  isDeterministic = mode;
+}
+
+void
+replace_external::set_overlap_update(bool mode) {
+  isOverlapUpdate = mode;
+}
+
+void
+replace_external::set_spec_step(int cand_count) {
+  if( cand_count > SPEC_STEP_MAX_CNT ) {
+    cout << "ERROR: set_spec_step takes at most " << SPEC_STEP_MAX_CNT 
+      << " candidates!" << endl;
+    exit(1);
+  }
+  specStepCnt = cand_count;
+}
+
+void
+replace_external::set_checkpoint_interval(int iter_count) {
+  ckptIter = (iter_count < 0)? 0 : iter_count;
+}
+
+void
+replace_external::set_resume_file(const char* file_name) {
+  resumeFile = file_name;
+}
+
 bool 
 replace_external::init_replace() {
   if( lef_stor.size() == 0 ) {
@@ -378,6 +513,17 @@ replace_external::place_cell_init_place() {
 
 bool
 replace_external::place_cell_nesterov_place() {
+  if( trialRunCMD ) {
+    // trial run from the initial placement, then roll back to it
+    place_snapshot_save();
+    setup_before_opt();
+    isTrial = true;
+    trial_main();
+    place_snapshot_restore();
+    place_snapshot_delete();
+    isTrial = false;
+  }
+
   setup_before_opt();
   if( placementMacroCNT > 0 ) {
     mGP2DglobalPlacement_main();
@@ -41,11 +41,13 @@ public:
   void set_verbose_level(int verbose);
   void set_fast_mode_enable(bool fast_mode);
   void set_seed_init_enable(bool seed_init);
+  void set_trial_run_enable(bool trial_run);
   void set_plot_color_file(std::string color_file);
   void set_write_bookshelf_enable(bool write_mode);
   
   void set_density(double density);
   void set_number_of_bin_grids(size_t grid_count);
+  void set_bin_auto_enable(bool mode);
   void set_lambda(double lambda);
   void set_min_pcof(double pcof_min);
   void set_max_pcof(double pcof_max);
@@ -58,6 +60,19 @@ public:
   void set_net_weight_scale(double net_weight_scale);
 
   void set_routability_driven(bool mode);
+
+  void set_wirelength_model(const char* model);
+  void set_high_fanout_threshold(int fanout);
+  void set_wlen_simd_enable(bool mode);
+  void set_wlen_net_grad_enable(bool mode);
+
+  void set_number_of_threads(int thread_count);
+  void set_deterministic(bool mode);
+  void set_overlap_update(bool mode);
+  void set_spec_step(int cand_count);
+
+  void set_checkpoint_interval(int iter_count);
+  void set_resume_file(const char* file_name);
   
   bool init_replace();
   bool place_cell_init_place();
@@ -73,11 +73,14 @@
 // for PREC_MODE variable => required for different codes.
 #define IS_FLOAT 0
 #define IS_DOUBLE 1
+#define IS_MIXED 2  // float storage, double reductions (prec_acc)
 
-// precision settings
+// precision settings; CMake passes PREC_MODE with PREC_MIXED / PREC_DOUBLE
+#ifndef PREC_MODE
 #define PREC_MODE IS_FLOAT
+#endif
 
-#if PREC_MODE == IS_FLOAT
+#if PREC_MODE == IS_FLOAT || PREC_MODE == IS_MIXED
 
 typedef float prec;
 #define PREC_MAX FLT_MAX
@@ -93,6 +96,14 @@ typedef double prec;
 
 #endif
 
+// accumulator for long reductions (potential, overflow, HPWL, norms) and
+// the Nesterov scalar state
+#if PREC_MODE == IS_FLOAT
+typedef float prec_acc;
+#else
+typedef double prec_acc;
+#endif
+
 #define INT_CONVERT(a) (int)(1.0 * (a) + 0.5f)
 #define INT_DOWN(a) (int)(a)
 #define INT_UP(a) (int)(a) + 1
@@ -463,6 +474,7 @@ struct TIER {
   struct FPOS pmin;
   struct FPOS pmax;
   struct BIN *bin_mat;
+  struct DEN_GRID *den_grid;
   struct FPOS center;
   struct FPOS size;
   struct ROW *row_st;
@@ -581,6 +593,16 @@ extern bool isSkipPlacement;
 extern bool hasDensityDP;
 extern bool isSkipIP;
 extern bool isBinSet;
+extern bool isBinAuto;
+extern bool isWlenSimd;
+extern bool isWlenNetGrad;
+extern int highFanoutThres;
+extern int wlenModel;
+extern bool isDeterministic;
+extern bool isOverlapUpdate;
+extern int specStepCnt;
+extern int ckptIter;
+extern std::string resumeFile;
 extern bool isDummyFill;
 extern prec densityDP;
 extern prec routeMaxDensity;
@@ -692,9 +714,9 @@ extern prec target_cell_den_orig;  // lutong
 extern prec total_macro_area;
 extern prec ignoreEdgeRatio;
 extern prec grad_stp;
-extern prec gsum_phi;
+extern prec_acc gsum_phi;
 extern prec gsum_ovfl;
-extern prec gsum_ovf_area;
+extern prec_acc gsum_ovf_area;
 extern prec overflowMin;
 extern prec mGP3D_opt_phi_cof;
 extern prec mGP2D_opt_phi_cof;
@@ -822,6 +844,8 @@ extern int numInitPlaceIter;
 extern std::string benchName;
 
 extern int numThread;
+extern int wlenThread;
+extern int binThread;
 enum class InputMode { bookshelf, lefdef };
 extern InputMode inputMode;
 
@@ -860,6 +884,9 @@ void init();
 void initialPlacement_main(void);
 void trial_main(void);
 void free_trial_mallocs(void);
+void place_snapshot_save(void);
+void place_snapshot_restore(void);
+void place_snapshot_delete(void);
 void tmGP3DglobalPlacement_main(void);
 void tmGP2DglobalPlacement_main(void);
 void tcGP3DglobalPlacement_main(void);
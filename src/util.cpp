@@ -65,6 +65,14 @@ prec get_abs(prec a) {
   return a < 0.0 ? -1.0 * a : a;
 }
 
+prec *AllocAlignedPrec(size_t cnt) {
+  void *ptr = NULL;
+  if(posix_memalign(&ptr, 64, sizeof(prec) * cnt) != 0) {
+    return NULL;
+  }
+  return (prec *)ptr;
+}
+
 unsigned prec2unsigned(prec a) {
   int af = floor(a);
   int ac = ceil(a);
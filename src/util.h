@@ -45,6 +45,9 @@ FPOS p2fp(struct POS a);
 
 prec get_abs(prec a);
 
+// cache-line aligned prec array; release with free()
+prec *AllocAlignedPrec(size_t cnt);
+
 
 // Rect common area functions
 int iGetCommonAreaXY(POS aLL, POS aUR, POS bLL, POS bUR);
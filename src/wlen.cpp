@@ -54,6 +54,7 @@
 #include "wlen.h"
 
 #include "lefdefIO.h"
+#include <flute.h>
 
 using std::min;
 using std::max;
@@ -81,6 +82,76 @@ FPOS base_wcof;
 FPOS wlen_cof;
 FPOS wlen_cof_inv;
 EXP_ST *exp_st;
+PLACE_GRAPH *place_graph = NULL;
+
+// per-net partial results (HPWL / wirelength) of the parallel net passes;
+// summed by SumNetVal in a fixed order instead of an omp reduction
+static FPOS *net_val = NULL;
+static int net_val_cap = 0;
+static prec_acc *net_val_blk = NULL;
+static int net_val_blk_cap = 0;
+
+static FPOS *GetNetValBuf(int cnt) {
+  if(net_val_cap < cnt) {
+    free(net_val);
+    net_val = (FPOS *)malloc(sizeof(FPOS) * cnt);
+    net_val_cap = cnt;
+  }
+  return net_val;
+}
+
+// sum of val[0, cnt). The range is cut into WLEN_SUM_BLOCK-sized
+// blocks regardless of -t; blocks are summed in parallel, then the block
+// sums in order, so the total is bit-identical for any thread count.
+// blk holds two entries per block.
+static void SumNetVal(const FPOS *val, prec_acc *blk, int cnt, prec_acc *sumX,
+                      prec_acc *sumY) {
+  int blkCnt = (cnt + WLEN_SUM_BLOCK - 1) / WLEN_SUM_BLOCK;
+  int b = 0;
+  omp_set_num_threads(wlenThread);
+#pragma omp parallel for default(none) \
+    shared(val, blk, cnt, blkCnt) private(b)
+  for(b = 0; b < blkCnt; b++) {
+    int i1 = min(cnt, (b + 1) * WLEN_SUM_BLOCK);
+    prec_acc x = 0, y = 0;
+    for(int i = b * WLEN_SUM_BLOCK; i < i1; i++) {
+      x += val[i].x;
+      y += val[i].y;
+    }
+    blk[2 * b] = x;
+    blk[2 * b + 1] = y;
+  }
+
+  *sumX = *sumY = 0;
+  for(b = 0; b < blkCnt; b++) {
+    *sumX += blk[2 * b];
+    *sumY += blk[2 * b + 1];
+  }
+}
+
+// sum of net_val[0, cnt)
+static void SumNetVal(int cnt, prec_acc *sumX, prec_acc *sumY) {
+  int blkCnt = (cnt + WLEN_SUM_BLOCK - 1) / WLEN_SUM_BLOCK;
+  if(net_val_blk_cap < blkCnt) {
+    free(net_val_blk);
+    net_val_blk = (prec_acc *)malloc(sizeof(prec_acc) * 2 * blkCnt);
+    net_val_blk_cap = blkCnt;
+  }
+  SumNetVal(net_val, net_val_blk, cnt, sumX, sumY);
+}
+
+static FPOS SumNetVal(int cnt) {
+  prec_acc sumX, sumY;
+  SumNetVal(cnt, &sumX, &sumY);
+  return FPOS(sumX, sumY);
+}
+
+// sum of g's per-net HPWL from the last net update
+static FPOS SumGraphNetVal(PLACE_GRAPH *g) {
+  prec_acc sumX, sumY;
+  SumNetVal(g->netVal, g->netValBlk, g->netCnt, &sumX, &sumY);
+  return FPOS(sumX, sumY);
+}
 
 void SetMAX_EXP_wlen() {
   MAX_EXP = 300;
@@ -185,59 +256,76 @@ void wcof_init(FPOS bstp) {
 }
 
 prec get_wlen() {
-  ////////////////////////////
-
-  switch(WLEN_MODEL) {
-    case WA:
-      return get_wlen_wa();
-      break;
-
+  switch(wlenModel) {
     case LSE:
-      return get_wlen_lse();
-      break;
+      return WlenLSE::Wlen();
+    case STN:
+      return WlenSTN::Wlen();
+    default:
+      return WlenWA::Wlen();
   }
-
-  ////////////////////////////
-  // return 0;
 }
 
 prec get_wlen_wa() {
   FPOS net_wlen;
   prec tot_wlen = 0;
-
-  total_wlen.SetZero();
+  prec_acc wlenX = 0, wlenY = 0;
 
   for(int i = 0; i < netCNT; i++) {
     net_wlen = get_net_wlen_wa(&netInstance[i]);
 
-    total_wlen.x += net_wlen.x;
-    total_wlen.y += net_wlen.y;
+    wlenX += net_wlen.x;
+    wlenY += net_wlen.y;
   }
 
+  total_wlen.x = wlenX;
+  total_wlen.y = wlenY;
   tot_wlen = total_wlen.x + total_wlen.y;  // +
 
   return tot_wlen;
 }
 
-prec get_wlen_lse(void) {
-  NET *net = NULL;
+// -wlmodel stn: WA length of each net scaled by its Steiner factor
+prec get_wlen_stn() {
+  PLACE_GRAPH *g = place_graph;
   FPOS net_wlen;
   prec tot_wlen = 0;
 
-  total_wlen.SetZero();
+  prec_acc wlenX = 0, wlenY = 0;
 
   for(int i = 0; i < netCNT; i++) {
-    net = &netInstance[i];
-    if(net->pinCNTinObject <= 1)
-      continue;
-    net_wlen = get_net_wlen_lse(net);
-    total_wlen.x += net_wlen.x;
-    total_wlen.y += net_wlen.y;
+    net_wlen = get_net_wlen_wa(&netInstance[i]);
+
+    wlenX += net_wlen.x * g->stnCof[i];
+    wlenY += net_wlen.y * g->stnCof[i];
   }
 
+  total_wlen.x = wlenX;
+  total_wlen.y = wlenY;
   tot_wlen = total_wlen.x + total_wlen.y;
 
   return tot_wlen;
+}
+
+prec get_wlen_lse(void) {
+  int i = 0;
+  FPOS *val = GetNetValBuf(netCNT);
+
+  omp_set_num_threads(wlenThread);
+#pragma omp parallel for default(none) shared(netCNT, netInstance, val) \
+    private(i)
+  for(i = 0; i < netCNT; i++) {
+    NET *net = &netInstance[i];
+    if(net->pinCNTinObject <= 1) {
+      val[i].SetZero();
+      continue;
+    }
+    val[i] = get_net_wlen_lse(net);
+  }
+
+  total_wlen = SumNetVal(netCNT);
+
+  return total_wlen.x + total_wlen.y;
 
   /* return  */
   /*   total_wlen.x * wlen_cof_inv.x * gp_wlen_weight.x + */
@@ -245,62 +333,61 @@ prec get_wlen_lse(void) {
 }
 
 FPOS get_net_wlen_wa(NET *net) {
+  PLACE_GRAPH *g = place_graph;
+  int n = net - netInstance;
   FPOS net_wlen;
-  FPOS sum_num1 = net->sum_num1;
-  FPOS sum_num2 = net->sum_num2;
-  FPOS sum_denom1 = net->sum_denom1;
-  FPOS sum_denom2 = net->sum_denom2;
 
-  if(net->pinCNTinObject <= 1)
+  if(g->netStart[n + 1] - g->netStart[n] <= 1)
     return FPOS(0,0);
 
+  FPOS sum_num1 = g->sumNum1[n];
+  FPOS sum_num2 = g->sumNum2[n];
+  FPOS sum_denom1 = g->sumDenom1[n];
+  FPOS sum_denom2 = g->sumDenom2[n];
+
   net_wlen.x = sum_num1.x / sum_denom1.x - sum_num2.x / sum_denom2.x;
   net_wlen.y = sum_num1.y / sum_denom1.y - sum_num2.y / sum_denom2.y;
 
   return net_wlen;
 }
 
+// log(sum exp(c x)) + log(sum exp(-c x)), evaluated around the net's
+// bbox from the last net_update so the exponentials cannot overflow
 FPOS get_net_wlen_lse(NET *net) {
+  PLACE_GRAPH *g = place_graph;
+  int n = net - netInstance;
+  FPOS netMin = g->netMin[n], netMax = g->netMax[n];
   FPOS sum1, sum2;
-  FPOS fp, wlen;
-  PIN *pin = NULL;
+  FPOS wlen;
 
-  for(int i = 0; i < net->pinCNTinObject; i++) {
-    pin = net->pin[i];
-    fp = pin->fp;
+  for(int s = g->netStart[n]; s < g->netStart[n + 1]; s++) {
+    FPOS fp = g->fp[s];
+    prec a1x = wlen_cof.x * (fp.x - netMax.x);
+    prec a1y = wlen_cof.y * (fp.y - netMax.y);
+    prec a2x = wlen_cof.x * (netMin.x - fp.x);
+    prec a2y = wlen_cof.y * (netMin.y - fp.y);
 
-    sum1.x += get_exp(wlen_cof.x * fp.x);
-    sum1.y += get_exp(wlen_cof.y * fp.y);
+    sum1.x += (fabs(a1x) < MAX_EXP) ? get_exp(a1x) : 0;
+    sum1.y += (fabs(a1y) < MAX_EXP) ? get_exp(a1y) : 0;
 
-    sum2.x += get_exp(-1.0 * wlen_cof.x * fp.x);
-    sum2.y += get_exp(-1.0 * wlen_cof.y * fp.y);
+    sum2.x += (fabs(a2x) < MAX_EXP) ? get_exp(a2x) : 0;
+    sum2.y += (fabs(a2y) < MAX_EXP) ? get_exp(a2y) : 0;
   }
 
-  wlen.x = log(sum1.x) + log(sum2.x);
-  wlen.y = log(sum1.y) + log(sum2.y);
+  wlen.x = wlen_cof.x * (netMax.x - netMin.x) + log(sum1.x) + log(sum2.x);
+  wlen.y = wlen_cof.y * (netMax.y - netMin.y) + log(sum1.y) + log(sum2.y);
 
   return wlen;
 }
 
 //
-// this only calculate HPWL based on the stored value in NET's ure
+// HPWL of the last net_update(); total_hpwl is reduced inside the net pass
 prec GetHpwl() {
-  total_hpwl.SetZero();
   total_stnwl.SetZero();
 
-  for(int i = 0; i < netCNT; i++) {
-    NET *curNet = &netInstance[i];
-    if(curNet->pinCNTinObject <= 1)
-      continue;
-
-    total_hpwl.x += curNet->max_x - curNet->min_x;
-    total_hpwl.y += curNet->max_y - curNet->min_y;
-
-    //// lutong
-    // total_stnwl.x += curNet->stn_cof * (curNet->max_x - curNet->min_x) ;
-    // total_stnwl.y += curNet->stn_cof * (curNet->max_y - curNet->min_y) ;
-
-  }
+  //// lutong
+  // total_stnwl.x += curNet->stn_cof * (curNet->max_x - curNet->min_x) ;
+  // total_stnwl.y += curNet->stn_cof * (curNet->max_y - curNet->min_y) ;
 
   return total_hpwl.x + total_hpwl.y;
 }
@@ -309,10 +396,15 @@ prec GetHpwl() {
 // this calculate current NET's informations (min_xyz/max_xyz) & calculate HPWL
 // simultaneously
 prec UpdateNetAndGetHpwl() {
-  FPOS pof, fp;
-  total_hpwl.SetZero();
+  int i = 0;
+  FPOS *val = GetNetValBuf(netCNT);
 
-  for(int i = 0; i < netCNT; i++) {
+  // runs before the place graph exists (initial placement), so this walks
+  // NET/PIN directly; min/max and HPWL are still one parallel pass
+  omp_set_num_threads(wlenThread);
+#pragma omp parallel for default(none) \
+    shared(netCNT, netInstance, moduleInstance, val) private(i)
+  for(i = 0; i < netCNT; i++) {
     NET *curNet = &netInstance[i];
 
     curNet->min_x = curNet->terminalMin.x;
@@ -341,47 +433,46 @@ prec UpdateNetAndGetHpwl() {
     }
 
     if(curNet->pinCNTinObject <= 1) {
+      val[i].SetZero();
       continue;
     }
 
     // calculate HPWL
-    total_hpwl.x += curNet->max_x - curNet->min_x;
-    total_hpwl.y += curNet->max_y - curNet->min_y;
+    val[i].x = curNet->max_x - curNet->min_x;
+    val[i].y = curNet->max_y - curNet->min_y;
   }
 
+  total_hpwl = SumNetVal(netCNT);
   return total_hpwl.x + total_hpwl.y;
 }
 
 void wlen_grad2(int cell_idx, FPOS *grad2) {
-  switch(WLEN_MODEL) {
+  switch(wlenModel) {
     case LSE:
-      wlen_grad2_lse(cell_idx, grad2);
+      WlenLSE::Grad2(cell_idx, grad2);
       break;
-
-    case WA:
-      wlen_grad2_wa(grad2);
+    case STN:
+      WlenSTN::Grad2(cell_idx, grad2);
+      break;
+    default:
+      WlenWA::Grad2(cell_idx, grad2);
       break;
   }
-  return;
 }
 
+// per-cell entry for callers outside the templated gradient loops
 void wlen_grad(int cell_idx, FPOS *grad) {
-  grad->SetZero();
-#ifdef NO_WLEN
-  return;
-#endif
-
-  switch(WLEN_MODEL) {
+  switch(wlenModel) {
     case LSE:
-      wlen_grad_lse(cell_idx, grad);
+      WlenGrad< WlenLSE >(place_graph, cell_idx, grad);
       break;
-
-    case WA:
-      wlen_grad_wa(cell_idx, grad);
+    case STN:
+      WlenGrad< WlenSTN >(place_graph, cell_idx, grad);
+      break;
+    default:
+      WlenGrad< WlenWA >(place_graph, cell_idx, grad);
       break;
   }
-  grad->x *= -1.0 * gp_wlen_weight.x;
-  grad->y *= -1.0 * gp_wlen_weight.y;
 }
 
 void wlen_grad2_wa(FPOS *grad) {
@@ -391,87 +482,71 @@ void wlen_grad2_wa(FPOS *grad) {
 }
 
 void wlen_grad2_lse(int cell_idx, FPOS *grad2) {
+  PLACE_GRAPH *g = place_graph;
   FPOS net_grad2;
-  CELL *cell = &gcell_st[cell_idx];
-  NET *net = NULL;
-  PIN *pin = NULL;
 
   grad2->SetZero();
+  if(cell_idx >= g->cellCnt)
+    return;
 
-  for(int i = 0; i < cell->pinCNTinObject; i++) {
-    pin = cell->pin[i];
-    net = &netInstance[pin->netID];
+  for(int k = g->cellStart[cell_idx]; k < g->cellStart[cell_idx + 1]; k++) {
+    int n = g->cellNet[k];
 
-    if(net->pinCNTinObject <= 1)
+    if(g->netStart[n + 1] - g->netStart[n] <= 1)
       continue;
 
-    get_net_wlen_grad2_lse(net, pin, &net_grad2);
+    get_net_wlen_grad2_lse(n, g->cellSlot[k], &net_grad2);
 
     grad2->x += net_grad2.x;
     grad2->y += net_grad2.y;
   }
 }
 
-void wlen_grad_lse(int cell_idx, FPOS *grad) {
-  FPOS net_grad;
-  CELL *cell = &gcell_st[cell_idx];
-  NET *net = NULL;
-  PIN *pin = NULL;
-
+// pinGrad already holds each slot's LSE gradient (see NetUpdateLse),
+// so this only streams over the cell's slots
+void wlen_grad_lse(PLACE_GRAPH *g, int cell_idx, FPOS *grad) {
   grad->SetZero();
+  if(cell_idx >= g->cellCnt)
+    return;
 
-  for(int i = 0; i < cell->pinCNTinObject; i++) {
-    pin = cell->pin[i];
-    net = &netInstance[pin->netID];
-
-    if(net->pinCNTinObject <= 1)
-      continue;
-
-    get_net_wlen_grad_lse(net, pin, &net_grad);
-
-    grad->x += net_grad.x;
-    grad->y += net_grad.y;
+  for(int k = g->cellStart[cell_idx]; k < g->cellStart[cell_idx + 1]; k++) {
+    grad->x += g->pinGrad[g->cellSlot[k]].x;
+    grad->y += g->pinGrad[g->cellSlot[k]].y;
   }
 }
 
-void wlen_grad_wa(int cell_idx, FPOS *grad) {
-  CELL *cell = &gcell_st[cell_idx];
-  PIN *pin = NULL;
-  NET *net = NULL;
+void wlen_grad_wa(PLACE_GRAPH *g, int cell_idx, FPOS *grad) {
   FPOS net_grad;
 
   grad->SetZero();
+  if(cell_idx >= g->cellCnt)
+    return;
 
-  for(int i = 0; i < cell->pinCNTinObject; i++) {
-    pin = cell->pin[i];
-    net = &netInstance[pin->netID];
+  // already reduced by net_update_wa
+  if(isWlenNetGrad) {
+    *grad = g->cellGrad[cell_idx];
+    return;
+  }
 
-    if(net->pinCNTinObject <= 1)
+  for(int k = g->cellStart[cell_idx]; k < g->cellStart[cell_idx + 1]; k++) {
+    int n = g->cellNet[k];
+
+    int deg = g->netStart[n + 1] - g->netStart[n];
+    if(deg <= 1)
       continue;
 
-    get_net_wlen_grad_wa(pin->fp, net, pin, &net_grad);
-
-    float curTimingWeight = netInstance[pin->netID].timingWeight;
-    // Timing Control Parts
-    // curTimingWeight = netWeightBase + min(max(0.0f, netWeightBound - netWeightBase),
-    // curTimingWeight / netWeightScale);
-    //
-    // cout << "calNetWeight: " << curTimingWeight << endl;
-    if(hasUnitNetWeight) {
-      net_grad.x *= netWeight;
-      net_grad.y *= netWeight;
-    }
-    else if( hasCustomNetWeight ) {
-      net_grad.x *= net->customWeight;
-      net_grad.y *= net->customWeight;
-    }
-    else if(isTiming && netWeightApply && curTimingWeight > 0) {
-      net_grad.x *= curTimingWeight;
-      net_grad.y *= curTimingWeight;
+    // pinGrad of 2/3-pin and high-fanout nets is already weighted
+    if(g->netKind[n] != WA_BUCKET_GENERIC) {
+      grad->x += g->pinGrad[g->cellSlot[k]].x;
+      grad->y += g->pinGrad[g->cellSlot[k]].y;
+      continue;
     }
 
-    grad->x += net_grad.x;
-    grad->y += net_grad.y;
+    get_net_wlen_grad_wa(g, n, g->cellSlot[k], &net_grad);
+
+    // unit / custom / timing weight, see net_update_wa
+    grad->x += net_grad.x * g->netWeight[n];
+    grad->y += net_grad.y * g->netWeight[n];
   }
 }
 
@@ -520,114 +595,65 @@ void initCustomNetWeight(string netWeightFile) {
   PrintProcBegin("CustomNetWeightEnd");
 }
 
-void get_net_wlen_grad2_lse(NET *net, PIN *pin, FPOS *grad2) {
-  POS flg1 = pin->flg1, flg2 = pin->flg2;
-  FPOS e1 = pin->e1, e2 = pin->e2;
-  FPOS grad2_1, grad2_2;
-  FPOS sum_denom1 = net->sum_denom1;
-  FPOS sum_denom2 = net->sum_denom2;
-
-  if(flg1.x) {
-    grad2_1.x = (e1.x) * (sum_denom1.x - e1.x) / (sum_denom1.x * sum_denom1.x);
-  }
-
-  if(flg2.x) {
-    grad2_2.x = (e2.x) * (sum_denom2.x - e2.x) / (sum_denom2.x * sum_denom2.x);
-  }
-
-  grad2->x = grad2_1.x + grad2_2.x;
-
-  if(flg1.y) {
-    grad2_1.y = (e1.y) * (sum_denom1.y - e1.y) / (sum_denom1.y * sum_denom1.y);
-  }
-
-  if(flg2.y) {
-    grad2_2.y = (e2.y) * (sum_denom2.y - e2.y) / (sum_denom2.y * sum_denom2.y);
-  }
-
-  grad2->y = grad2_1.y + grad2_2.y;
-
-  return;
+// A clipped exponential is stored as 0, which drops the pin from the
+// sums and the gradients the same way the old flg1/flg2 bits did.
+void get_net_wlen_grad2_lse(int netIdx, int slot, FPOS *grad2) {
+  PLACE_GRAPH *g = place_graph;
+  FPOS e1 = g->e1[slot], e2 = g->e2[slot];
+  FPOS sum_denom1 = g->sumDenom1[netIdx];
+  FPOS sum_denom2 = g->sumDenom2[netIdx];
+
+  grad2->x = (e1.x) * (sum_denom1.x - e1.x) / (sum_denom1.x * sum_denom1.x) +
+             (e2.x) * (sum_denom2.x - e2.x) / (sum_denom2.x * sum_denom2.x);
+  grad2->y = (e1.y) * (sum_denom1.y - e1.y) / (sum_denom1.y * sum_denom1.y) +
+             (e2.y) * (sum_denom2.y - e2.y) / (sum_denom2.y * sum_denom2.y);
 }
 
-void get_net_wlen_grad_lse(NET *net, PIN *pin, FPOS *grad) {
-  POS flg1 = pin->flg1, flg2 = pin->flg2;
-  FPOS grad1, grad2;
-  FPOS e1 = pin->e1, e2 = pin->e2;
-  FPOS sum_denom1 = net->sum_denom1;
-  FPOS sum_denom2 = net->sum_denom2;
-
-  if(flg1.x) {
-    grad1.x = e1.x / sum_denom1.x;
-  }
-
-  if(flg2.x) {
-    grad2.x = e2.x / sum_denom2.x;
-  }
-
-  grad->x = grad1.x - grad2.x;
-
-  if(flg1.y) {
-    grad1.y = e1.y / sum_denom1.y;
-  }
+void get_net_wlen_grad_lse(int netIdx, int slot, FPOS *grad) {
+  PLACE_GRAPH *g = place_graph;
+  FPOS e1 = g->e1[slot], e2 = g->e2[slot];
+  FPOS sum_denom1 = g->sumDenom1[netIdx];
+  FPOS sum_denom2 = g->sumDenom2[netIdx];
 
-  if(flg2.y) {
-    grad2.y = e2.y / sum_denom2.y;
-  }
-
-  grad->y = grad1.y - grad2.y;
-
-  return;
+  grad->x = e1.x / sum_denom1.x - e2.x / sum_denom2.x;
+  grad->y = e1.y / sum_denom1.y - e2.y / sum_denom2.y;
 }
 
 // wlen_cof
-// obj?
+// obj: the pin location
 //
-void get_net_wlen_grad_wa(FPOS obj, NET *net, PIN *pin, FPOS *grad) {
+void get_net_wlen_grad_wa(PLACE_GRAPH *g, int netIdx, int slot, FPOS *grad) {
   FPOS grad_sum_num1, grad_sum_num2;
   FPOS grad_sum_denom1, grad_sum_denom2;
   FPOS grad1;
   FPOS grad2;
-  FPOS e1 = pin->e1;
-  FPOS e2 = pin->e2;
-  POS flg1 = pin->flg1;
-  POS flg2 = pin->flg2;
-  FPOS sum_num1 = net->sum_num1;
-  FPOS sum_num2 = net->sum_num2;
-  FPOS sum_denom1 = net->sum_denom1;
-  FPOS sum_denom2 = net->sum_denom2;
-
-  if(flg1.x) {
-    grad_sum_denom1.x = wlen_cof.x * e1.x;
-    grad_sum_num1.x = e1.x + obj.x * grad_sum_denom1.x;
-    grad1.x =
-        (grad_sum_num1.x * sum_denom1.x - grad_sum_denom1.x * sum_num1.x) /
-        (sum_denom1.x * sum_denom1.x);
-  }
-
-  if(flg1.y) {
-    grad_sum_denom1.y = wlen_cof.y * e1.y;
-    grad_sum_num1.y = e1.y + obj.y * grad_sum_denom1.y;
-    grad1.y =
-        (grad_sum_num1.y * sum_denom1.y - grad_sum_denom1.y * sum_num1.y) /
-        (sum_denom1.y * sum_denom1.y);
-  }
-
-  if(flg2.x) {
-    grad_sum_denom2.x = wlen_cof.x * e2.x;
-    grad_sum_num2.x = e2.x - obj.x * grad_sum_denom2.x;
-    grad2.x =
-        (grad_sum_num2.x * sum_denom2.x + grad_sum_denom2.x * sum_num2.x) /
-        (sum_denom2.x * sum_denom2.x);
-  }
-
-  if(flg2.y) {
-    grad_sum_denom2.y = wlen_cof.y * e2.y;
-    grad_sum_num2.y = e2.y - obj.y * grad_sum_denom2.y;
-    grad2.y =
-        (grad_sum_num2.y * sum_denom2.y + grad_sum_denom2.y * sum_num2.y) /
-        (sum_denom2.y * sum_denom2.y);
-  }
+  FPOS obj = g->fp[slot];
+  FPOS e1 = g->e1[slot];
+  FPOS e2 = g->e2[slot];
+  FPOS sum_num1 = g->sumNum1[netIdx];
+  FPOS sum_num2 = g->sumNum2[netIdx];
+  FPOS sum_denom1 = g->sumDenom1[netIdx];
+  FPOS sum_denom2 = g->sumDenom2[netIdx];
+
+  grad_sum_denom1.x = wlen_cof.x * e1.x;
+  grad_sum_num1.x = e1.x + obj.x * grad_sum_denom1.x;
+  grad1.x = (grad_sum_num1.x * sum_denom1.x - grad_sum_denom1.x * sum_num1.x) /
+            (sum_denom1.x * sum_denom1.x);
+
+  grad_sum_denom1.y = wlen_cof.y * e1.y;
+  grad_sum_num1.y = e1.y + obj.y * grad_sum_denom1.y;
+  grad1.y = (grad_sum_num1.y * sum_denom1.y - grad_sum_denom1.y * sum_num1.y) /
+            (sum_denom1.y * sum_denom1.y);
+
+  grad_sum_denom2.x = wlen_cof.x * e2.x;
+  grad_sum_num2.x = e2.x - obj.x * grad_sum_denom2.x;
+  grad2.x = (grad_sum_num2.x * sum_denom2.x + grad_sum_denom2.x * sum_num2.x) /
+            (sum_denom2.x * sum_denom2.x);
+
+  grad_sum_denom2.y = wlen_cof.y * e2.y;
+  grad_sum_num2.y = e2.y - obj.y * grad_sum_denom2.y;
+  grad2.y = (grad_sum_num2.y * sum_denom2.y + grad_sum_denom2.y * sum_num2.y) /
+            (sum_denom2.y * sum_denom2.y);
 
   grad->x = grad1.x - grad2.x;
   grad->y = grad1.y - grad2.y;
@@ -660,159 +686,494 @@ void net_update_init(void) {
   }
 }
 
-void net_update(FPOS *st) {
-  switch(WLEN_MODEL) {
-    case LSE:
-      return net_update_lse(st);
-      break;
-    case WA:
-      return net_update_wa(st);
-      break;
+// Expected RSMT / HPWL of a net by degree, measured with FLUTE on
+// STN_COF_SAMPLES uniformly random nets per degree (fixed seed, so runs are
+// reproducible). Degrees <= 3 are exact at 1.0. Past STN_COF_FLUTE_DEG the
+// ratio follows the sqrt(deg) growth of random RSMT length (Beardwood et al.);
+// FLUTE measures RSMT / HPWL / sqrt(deg) at 0.41 for deg 32 and 0.39 for
+// deg 1000, so anchoring at deg 32 stays within 4% up to FLUTE_MAXD.
+#define STN_COF_FLUTE_DEG 32
+#define STN_COF_SAMPLES 32
+#define STN_COF_RANGE 65536
+
+static prec MeasureSteinerCof(int deg) {
+  FLUTE_DTYPE x[STN_COF_FLUTE_DEG], y[STN_COF_FLUTE_DEG];
+  unsigned int seed = deg;
+  double rsmt = 0, hpwl = 0;
+
+  for(int s = 0; s < STN_COF_SAMPLES; s++) {
+    FLUTE_DTYPE minX = STN_COF_RANGE, maxX = 0;
+    FLUTE_DTYPE minY = STN_COF_RANGE, maxY = 0;
+    for(int j = 0; j < deg; j++) {
+      x[j] = rand_r(&seed) % STN_COF_RANGE;
+      y[j] = rand_r(&seed) % STN_COF_RANGE;
+      minX = min(minX, x[j]);
+      maxX = max(maxX, x[j]);
+      minY = min(minY, y[j]);
+      maxY = max(maxY, y[j]);
+    }
+    rsmt += Flute::flute_wl(deg, x, y, FLUTE_ACCURACY);
+    hpwl += (maxX - minX) + (maxY - minY);
   }
+  return (hpwl > 0) ? max(1.0, rsmt / hpwl) : 1.0;
 }
 
-void net_update_lse(FPOS *st) {
-  int i = 0, j = 0;
-  CELL *cell = NULL;
-  NET *net = NULL;
-  PIN *pin = NULL;
-  MODULE *curModule = NULL;
-  FPOS fp, pof, center;
-  FPOS sum_denom1, sum_denom2;
-  prec exp_val = 0;
-  prec min_x = 0, min_y = 0;
-  prec max_x = 0, max_y = 0;
-  prec exp_min_x = 0, exp_min_y = 0;
-  prec exp_max_x = 0, exp_max_y = 0;
+// Fills stnCof for every net. FLUTE only runs for the degrees that occur,
+// so small designs pay a few milliseconds.
+static void SetSteinerCof(PLACE_GRAPH *g) {
+  prec cofTable[STN_COF_FLUTE_DEG + 1];
+  bool cofValid[STN_COF_FLUTE_DEG + 1] = {false, };
 
-  for(i = 0; i < gcell_cnt; i++) {
-    cell = &gcell_st[i];
+  Flute::readLUT("./POWV9.dat", "./PORT9.dat");
 
-    cell->center = st[i];
+  for(int i = 0; i < netCNT; i++) {
+    int deg = netInstance[i].pinCNTinObject;
+    int d = min(deg, STN_COF_FLUTE_DEG);
 
-    cell->den_pmin.x = cell->center.x - cell->half_den_size.x;
-    cell->den_pmin.y = cell->center.y - cell->half_den_size.y;
-    // cell->den_pmin.z = cell->center.z - cell->half_den_size.z;
+    if(d <= 3) {
+      g->stnCof[i] = 1.0;
+      continue;
+    }
+    if(!cofValid[d]) {
+      cofTable[d] = MeasureSteinerCof(d);
+      cofValid[d] = true;
+    }
+    g->stnCof[i] = cofTable[d];
+    if(deg > STN_COF_FLUTE_DEG) {
+      g->stnCof[i] *= sqrt((prec)deg / STN_COF_FLUTE_DEG);
+    }
+  }
+}
 
-    cell->den_pmax.x = cell->center.x + cell->half_den_size.x;
-    cell->den_pmax.y = cell->center.y + cell->half_den_size.y;
-    // cell->den_pmax.z = cell->center.z + cell->half_den_size.z;
+static int GetWaBucket(PLACE_GRAPH *g, int netIdx) {
+  int deg = g->netStart[netIdx + 1] - g->netStart[netIdx];
+  if(highFanoutThres > 0 && deg > highFanoutThres &&
+     deg > 4 * HIGH_FANOUT_KEEP_PINS) {
+    return WA_BUCKET_HIGH_FANOUT;
   }
 
-  for(i = 0; i < netCNT; i++) {
-    net = &netInstance[i];
+  switch(deg) {
+    case 2:
+      return WA_BUCKET_DEG2;
+    case 3:
+      return WA_BUCKET_DEG3;
+    default:
+      return WA_BUCKET_GENERIC;
+  }
+}
 
-    net->min_x = net->terminalMin.x;
-    net->min_y = net->terminalMin.y;
-    // net->min_z = net->terminalMin.z;
+static int GetHfCnt(PLACE_GRAPH *g) {
+  return g->bucketStart[WA_BUCKET_HIGH_FANOUT + 1] -
+         g->bucketStart[WA_BUCKET_HIGH_FANOUT];
+}
 
-    net->max_x = net->terminalMax.x;
-    net->max_y = net->terminalMax.y;
-    // net->max_z = net->terminalMax.z;
+// the per-evaluation arrays of g, i.e. everything the net passes and the
+// gradient kernels write; the rest of the graph is fixed topology
+static void AllocGraphState(PLACE_GRAPH *g) {
+  int hfCnt = GetHfCnt(g);
+  int blkCnt = (g->netCnt + WLEN_SUM_BLOCK - 1) / WLEN_SUM_BLOCK;
+
+  g->fp = (FPOS *)malloc(sizeof(FPOS) * g->pinCnt);
+  g->e1 = (FPOS *)malloc(sizeof(FPOS) * g->pinCnt);
+  g->e2 = (FPOS *)malloc(sizeof(FPOS) * g->pinCnt);
+  g->pinGrad = (FPOS *)malloc(sizeof(FPOS) * g->pinCnt);
+
+  g->netMin = (FPOS *)malloc(sizeof(FPOS) * g->netCnt);
+  g->netMax = (FPOS *)malloc(sizeof(FPOS) * g->netCnt);
+  g->sumNum1 = (FPOS *)malloc(sizeof(FPOS) * g->netCnt);
+  g->sumNum2 = (FPOS *)malloc(sizeof(FPOS) * g->netCnt);
+  g->sumDenom1 = (FPOS *)malloc(sizeof(FPOS) * g->netCnt);
+  g->sumDenom2 = (FPOS *)malloc(sizeof(FPOS) * g->netCnt);
+  g->netWeight = (prec *)malloc(sizeof(prec) * g->netCnt);
+  g->netVal = (FPOS *)malloc(sizeof(FPOS) * g->netCnt);
+  g->netValBlk = (prec_acc *)malloc(sizeof(prec_acc) * 2 * blkCnt);
+
+  g->hfSel = (int *)malloc(sizeof(int) * 4 * HIGH_FANOUT_KEEP_PINS * hfCnt);
+  g->hfValid = (bool *)malloc(sizeof(bool) * hfCnt);
+  for(int j = 0; j < hfCnt; j++) {
+    g->hfValid[j] = false;
+  }
 
-    for(j = 0; j < net->pinCNTinObject; j++) {
-      pin = net->pin[j];
+  g->cellGrad = (FPOS *)malloc(sizeof(FPOS) * g->cellCnt);
+}
 
-      if(!pin->term) {
-        curModule = &moduleInstance[pin->moduleID];
-        pof = curModule->pof[pin->pinIDinModule];
-        center = st[pin->moduleID];
-        fp.x = center.x + pof.x;
-        fp.y = center.y + pof.y;
-        // fp.z = center.z + pof.z ;
-        pin->fp = fp;
+static void FreeGraphState(PLACE_GRAPH *g) {
+  free(g->fp);
+  free(g->e1);
+  free(g->e2);
+  free(g->pinGrad);
+  free(g->netMin);
+  free(g->netMax);
+  free(g->sumNum1);
+  free(g->sumNum2);
+  free(g->sumDenom1);
+  free(g->sumDenom2);
+  free(g->netWeight);
+  free(g->netVal);
+  free(g->netValBlk);
+  free(g->hfSel);
+  free(g->hfValid);
+  free(g->cellGrad);
+}
 
-        net->min_x = min(net->min_x, fp.x);
-        net->min_y = min(net->min_y, fp.y);
-        // net->min_z = min ( net->min_z , fp.z ) ;
+// Flattens netInstance[].pin / gcell_st[].pin into the CSR arrays of
+// place_graph. Must run after cell_init() removed the duplicated pins.
+void place_graph_build(void) {
+  place_graph_delete();
 
-        net->max_x = max(net->max_x, fp.x);
-        net->max_y = max(net->max_y, fp.y);
-        // net->max_z = max ( net->max_z , fp.z ) ;
+  PLACE_GRAPH *g = (PLACE_GRAPH *)malloc(sizeof(PLACE_GRAPH));
+  g->netCnt = netCNT;
+  g->cellCnt = moduleCNT;
+  g->isNetSync = true;
+
+  g->netStart = (int *)malloc(sizeof(int) * (netCNT + 1));
+  g->netStart[0] = 0;
+  for(int i = 0; i < netCNT; i++) {
+    g->netStart[i + 1] = g->netStart[i] + netInstance[i].pinCNTinObject;
+  }
+  g->pinCnt = g->netStart[netCNT];
+
+  // bucket the nets by degree once; net_update_wa runs one loop per bucket
+  int bucketCnt[WA_BUCKET_CNT] = {0, };
+  for(int i = 0; i < netCNT; i++) {
+    bucketCnt[GetWaBucket(g, i)]++;
+  }
+  g->bucketStart[0] = 0;
+  for(int b = 0; b < WA_BUCKET_CNT; b++) {
+    g->bucketStart[b + 1] = g->bucketStart[b] + bucketCnt[b];
+    bucketCnt[b] = g->bucketStart[b];
+  }
+  g->netBucket = (int *)malloc(sizeof(int) * netCNT);
+  g->netKind = (unsigned char *)malloc(sizeof(unsigned char) * netCNT);
+  for(int i = 0; i < netCNT; i++) {
+    int b = GetWaBucket(g, i);
+    g->netKind[i] = b;
+    g->netBucket[bucketCnt[b]++] = i;
+  }
+
+  AllocGraphState(g);
+
+  g->pinModule = (int *)malloc(sizeof(int) * g->pinCnt);
+  g->pof = (FPOS *)malloc(sizeof(FPOS) * g->pinCnt);
+  g->stnCof = (prec *)malloc(sizeof(prec) * netCNT);
+
+  for(int i = 0; i < netCNT; i++) {
+    NET *net = &netInstance[i];
+    for(int j = 0; j < net->pinCNTinObject; j++) {
+      PIN *pin = net->pin[j];
+      int s = g->netStart[i] + j;
+
+      if(pin->term) {
+        g->pinModule[s] = -1;
+        g->pof[s].SetZero();
       }
       else {
-        continue;
+        g->pinModule[s] = pin->moduleID;
+        g->pof[s] = moduleInstance[pin->moduleID].pof[pin->pinIDinModule];
       }
+      g->fp[s] = pin->fp;
+      g->e1[s].SetZero();
+      g->e2[s].SetZero();
+      g->pinGrad[s].SetZero();
     }
+    g->netMin[i] = net->terminalMin;
+    g->netMax[i] = net->terminalMax;
+    g->netWeight[i] = 1.0;
+    g->stnCof[i] = 1.0;
+  }
+  if(wlenModel == STN) {
+    SetSteinerCof(g);
+  }
 
-    min_x = net->min_x;
-    min_y = net->min_y;
-    // min_z = net->min_z ;
+  int hfCnt = GetHfCnt(g);
+  int hfPinCnt = 0;
+  for(int j = 0; j < hfCnt; j++) {
+    int n = g->netBucket[g->bucketStart[WA_BUCKET_HIGH_FANOUT] + j];
+    hfPinCnt += g->netStart[n + 1] - g->netStart[n];
+  }
+  if(highFanoutThres > 0) {
+    PrintInfoInt("HighFanout: ApproxNets", hfCnt, 1);
+    PrintInfoInt("HighFanout: ApproxPins", hfPinCnt, 1);
+  }
 
-    max_x = net->max_x;
-    max_y = net->max_y;
-    // max_z = net->max_z;
+  g->cellStart = (int *)malloc(sizeof(int) * (moduleCNT + 1));
+  g->cellStart[0] = 0;
+  for(int i = 0; i < moduleCNT; i++) {
+    g->cellStart[i + 1] = g->cellStart[i] + gcell_st[i].pinCNTinObject;
+  }
 
-    sum_denom1.x = sum_denom1.y = 0;
-    sum_denom2.x = sum_denom2.y = 0;
+  int cellPinCnt = g->cellStart[moduleCNT];
+  g->cellSlot = (int *)malloc(sizeof(int) * cellPinCnt);
+  g->cellNet = (int *)malloc(sizeof(int) * cellPinCnt);
+
+  for(int i = 0; i < moduleCNT; i++) {
+    CELL *cell = &gcell_st[i];
+    for(int j = 0; j < cell->pinCNTinObject; j++) {
+      PIN *pin = cell->pin[j];
+      int k = g->cellStart[i] + j;
+      g->cellNet[k] = pin->netID;
+      g->cellSlot[k] = g->netStart[pin->netID] + pin->pinIDinNet;
+    }
+  }
 
-    for(j = 0; j < net->pinCNTinObject; j++) {
-      pin = net->pin[j];
+  place_graph = g;
+}
 
-      if(!pin->term) {
+void place_graph_delete(void) {
+  PLACE_GRAPH *g = place_graph;
+  if(!g)
+    return;
+
+  FreeGraphState(g);
+  free(g->netStart);
+  free(g->pinModule);
+  free(g->pof);
+  free(g->stnCof);
+  free(g->netBucket);
+  free(g->netKind);
+  free(net_val);
+  free(net_val_blk);
+  net_val = NULL;
+  net_val_blk = NULL;
+  net_val_cap = net_val_blk_cap = 0;
+  free(g->cellStart);
+  free(g->cellSlot);
+  free(g->cellNet);
+  free(g);
+
+  place_graph = NULL;
+}
+
+// A graph sharing place_graph's topology with its own per-evaluation
+// arrays, for one -specStep candidate (ns.cpp). The terminal pin
+// locations are copied since the net passes never write them.
+PLACE_GRAPH *place_graph_clone(void) {
+  PLACE_GRAPH *g = (PLACE_GRAPH *)malloc(sizeof(PLACE_GRAPH));
+  *g = *place_graph;
+  g->isNetSync = false;
+
+  AllocGraphState(g);
+  memcpy(g->fp, place_graph->fp, sizeof(FPOS) * g->pinCnt);
+  return g;
+}
+
+void place_graph_clone_delete(PLACE_GRAPH *g) {
+  if(!g)
+    return;
+  FreeGraphState(g);
+  free(g);
+}
+
+// make the last evaluation of clone g place_graph's: the per-evaluation
+// arrays are exchanged (g gets place_graph's old ones) and the bboxes are
+// written back to netInstance
+void place_graph_adopt(PLACE_GRAPH *g) {
+  PLACE_GRAPH *p = place_graph;
+  int i = 0;
+
+  std::swap(p->fp, g->fp);
+  std::swap(p->e1, g->e1);
+  std::swap(p->e2, g->e2);
+  std::swap(p->pinGrad, g->pinGrad);
+  std::swap(p->netMin, g->netMin);
+  std::swap(p->netMax, g->netMax);
+  std::swap(p->sumNum1, g->sumNum1);
+  std::swap(p->sumNum2, g->sumNum2);
+  std::swap(p->sumDenom1, g->sumDenom1);
+  std::swap(p->sumDenom2, g->sumDenom2);
+  std::swap(p->netWeight, g->netWeight);
+  std::swap(p->netVal, g->netVal);
+  std::swap(p->netValBlk, g->netValBlk);
+  std::swap(p->hfSel, g->hfSel);
+  std::swap(p->hfValid, g->hfValid);
+  std::swap(p->cellGrad, g->cellGrad);
+
+  omp_set_num_threads(numThread);
+#pragma omp parallel for default(none) shared(p, netInstance) private(i)
+  for(i = 0; i < p->netCnt; i++) {
+    NET *net = &netInstance[i];
+    net->min_x = p->netMin[i].x;
+    net->min_y = p->netMin[i].y;
+    net->max_x = p->netMax[i].x;
+    net->max_y = p->netMax[i].y;
+  }
+}
+
+void net_update(FPOS *st, bool isCellUpdate) {
+  switch(wlenModel) {
+    case LSE:
+      WlenLSE::NetUpdate(st, isCellUpdate);
+      break;
+    case STN:
+      WlenSTN::NetUpdate(st, isCellUpdate);
+      break;
+    default:
+      WlenWA::NetUpdate(st, isCellUpdate);
+      break;
+  }
+}
+
+// routability / bookshelf writers still read the bbox off the NET; a
+// -specStep candidate graph keeps it to itself until it is adopted
+static inline void SetNetBox(PLACE_GRAPH *g, NET *net, int n, FPOS netMin,
+                             FPOS netMax) {
+  if(g->isNetSync) {
+    net->min_x = netMin.x;
+    net->min_y = netMin.y;
+    net->max_x = netMax.x;
+    net->max_y = netMax.y;
+  }
+  g->netMin[n] = netMin;
+  g->netMax[n] = netMax;
+}
+
+// LSE terms of one net. Exponents are shifted by the net's bbox so they
+// stay in (-MAX_EXP, 0]; the slot loop is branch-free (out-of-range terms
+// are selected to 0) and vectorizes. Also emits the per-slot gradient
+// e1 / sum_denom1 - e2 / sum_denom2 into pinGrad. Returns the net's HPWL.
+static FPOS NetUpdateLse(PLACE_GRAPH *g, int n, FPOS *st) {
+  NET *net = &netInstance[n];
+  int s0 = g->netStart[n], s1 = g->netStart[n + 1];
+  FPOS netMin = net->terminalMin, netMax = net->terminalMax;
+
+  for(int s = s0; s < s1; s++) {
+    int moduleID = g->pinModule[s];
+    if(moduleID < 0)
+      continue;
+
+    FPOS fp;
+    fp.x = st[moduleID].x + g->pof[s].x;
+    fp.y = st[moduleID].y + g->pof[s].y;
+    g->fp[s] = fp;
+
+    netMin.x = min(netMin.x, fp.x);
+    netMin.y = min(netMin.y, fp.y);
+    netMax.x = max(netMax.x, fp.x);
+    netMax.y = max(netMax.y, fp.y);
+  }
+
+  SetNetBox(g, net, n, netMin, netMax);
+
+  prec *fp = (prec *)g->fp;
+  prec *e1 = (prec *)g->e1;
+  prec *e2 = (prec *)g->e2;
+  prec cofX = wlen_cof.x, cofY = wlen_cof.y;
+  prec minX = netMin.x, minY = netMin.y;
+  prec maxX = netMax.x, maxY = netMax.y;
+  prec maxExp = MAX_EXP;
+  prec den1X = 0, den1Y = 0, den2X = 0, den2Y = 0;
+
+#pragma omp simd reduction(+ : den1X, den1Y, den2X, den2Y)
+  for(int s = s0; s < s1; s++) {
+    prec x = fp[2 * s], y = fp[2 * s + 1];
 #ifdef CELL_CENTER_WLEN_GRAD
-        fp = st[pin->moduleID];
-#else
-        fp = pin->fp;
+    if(g->pinModule[s] >= 0) {
+      x = st[g->pinModule[s]].x;
+      y = st[g->pinModule[s]].y;
+    }
 #endif
-      }
-      else {
-        fp = pin->fp;
-      }
+    prec aMaxX = (x - maxX) * cofX;
+    prec aMinX = (minX - x) * cofX;
+    prec aMaxY = (y - maxY) * cofY;
+    prec aMinY = (minY - y) * cofY;
+
+    prec e1X = get_exp(aMaxX);
+    prec e2X = get_exp(aMinX);
+    prec e1Y = get_exp(aMaxY);
+    prec e2Y = get_exp(aMinY);
+
+    e1X = (fabs(aMaxX) < maxExp) ? e1X : 0;
+    e2X = (fabs(aMinX) < maxExp) ? e2X : 0;
+    e1Y = (fabs(aMaxY) < maxExp) ? e1Y : 0;
+    e2Y = (fabs(aMinY) < maxExp) ? e2Y : 0;
+
+    e1[2 * s] = e1X;
+    e1[2 * s + 1] = e1Y;
+    e2[2 * s] = e2X;
+    e2[2 * s + 1] = e2Y;
+
+    den1X += e1X;
+    den1Y += e1Y;
+    den2X += e2X;
+    den2Y += e2Y;
+  }
 
-      exp_max_x = (fp.x - max_x) * wlen_cof.x;
+  g->sumDenom1[n] = FPOS(den1X, den1Y);
+  g->sumDenom2[n] = FPOS(den2X, den2Y);
 
-      if(fabs(exp_max_x) < MAX_EXP) {
-        exp_val = get_exp(exp_max_x);
-        sum_denom1.x += exp_val;
-        pin->flg1.x = 1;
-        pin->e1.x = exp_val;
-      }
-      else {
-        exp_val = 0;
-        pin->flg1.x = 0;
-      }
+  if(s1 - s0 <= 1) {
+    for(int s = s0; s < s1; s++) {
+      g->pinGrad[s].SetZero();
+    }
+    return FPOS(0, 0);
+  }
 
-      exp_min_x = (min_x - fp.x) * wlen_cof.x;
+  prec inv1X = 1.0 / den1X, inv1Y = 1.0 / den1Y;
+  prec inv2X = 1.0 / den2X, inv2Y = 1.0 / den2Y;
+  prec *pinGrad = (prec *)g->pinGrad;
 
-      if(fabs(exp_min_x) < MAX_EXP) {
-        exp_val = get_exp(exp_min_x);
-        sum_denom2.x += exp_val;
-        pin->flg2.x = 1;
-        pin->e2.x = exp_val;
-      }
-      else {
-        pin->flg2.x = 0;
-      }
+#pragma omp simd
+  for(int s = s0; s < s1; s++) {
+    pinGrad[2 * s] = e1[2 * s] * inv1X - e2[2 * s] * inv2X;
+    pinGrad[2 * s + 1] = e1[2 * s + 1] * inv1Y - e2[2 * s + 1] * inv2Y;
+  }
 
-      exp_max_y = (fp.y - max_y) * wlen_cof.y;
+  return FPOS(netMax.x - netMin.x, netMax.y - netMin.y);
+}
 
-      if(fabs(exp_max_y) < MAX_EXP) {
-        exp_val = get_exp(exp_max_y);
-        sum_denom1.y += exp_val;
-        pin->flg1.y = 1;
-        pin->e1.y = exp_val;
-      }
-      else {
-        pin->flg1.y = 0;
-      }
+// move the gcells to st: center and density box. The net passes only read
+// st, so with isCellUpdate = false they can run beside bin_update(), which
+// reads the cells (see -overlap in ns.cpp).
+void net_update_cells(FPOS *st) {
+  int i = 0;
 
-      exp_min_y = (min_y - fp.y) * wlen_cof.y;
+  omp_set_num_threads(numThread);
+#pragma omp parallel default(none) shared(gcell_cnt, gcell_st, st) private(i)
+  {
+#pragma omp for
+    for(i = 0; i < gcell_cnt; i++) {
+      CELL *cell = &gcell_st[i];
 
-      if(fabs(exp_min_y) < MAX_EXP) {
-        exp_val = get_exp(exp_min_y);
-        sum_denom2.y += exp_val;
-        pin->flg2.y = 1;
-        pin->e2.y = exp_val;
-      }
-      else {
-        pin->flg2.y = 0;
-      }
+      cell->center = st[i];
+
+      cell->den_pmin.x = cell->center.x - cell->half_den_size.x;
+      cell->den_pmin.y = cell->center.y - cell->half_den_size.y;
+      // cell->den_pmin.z = cell->center.z - cell->half_den_size.z;
+
+      cell->den_pmax.x = cell->center.x + cell->half_den_size.x;
+      cell->den_pmax.y = cell->center.y + cell->half_den_size.y;
+      // cell->den_pmax.z = cell->center.z + cell->half_den_size.z;
     }
+  }
+}
+
+void net_update_lse(FPOS *st, bool isCellUpdate) {
+  if(isCellUpdate) {
+    net_update_cells(st);
+  }
+  total_hpwl = net_update_lse_graph(place_graph, st);
+}
+
+// LSE pass over g at st; returns the HPWL
+FPOS net_update_lse_graph(PLACE_GRAPH *g, FPOS *st) {
+  int i = 0;
+  FPOS *val = g->netVal;
+
+  omp_set_num_threads(wlenThread);
+#pragma omp parallel for default(none) shared(g, st, val) private(i)
+  for(i = 0; i < g->netCnt; i++) {
+    val[i] = NetUpdateLse(g, i, st);
+  }
 
-    net->sum_denom1 = sum_denom1;
-    net->sum_denom2 = sum_denom2;
+  return SumGraphNetVal(g);
+}
+
+// net pass of the current -wlmodel over g at st; returns the HPWL
+FPOS net_update_graph(PLACE_GRAPH *g, FPOS *st) {
+  if(wlenModel == LSE) {
+    return net_update_lse_graph(g, st);
   }
+  return net_update_wa_graph(g, st);
 }
 
 prec net_update_hpwl_mac(void) {
@@ -868,171 +1229,452 @@ prec net_update_hpwl_mac(void) {
   return hpwl;
 }
 
+// unit / custom / timing weight of the WA gradient, times the Steiner
+// factor under -wlmodel stn
+static inline prec GetWaNetWeight(PLACE_GRAPH *g, int n) {
+  NET *net = &netInstance[n];
+  prec stnCof = (wlenModel == STN) ? g->stnCof[n] : 1.0;
+
+  // Timing Control Parts
+  if(hasUnitNetWeight) {
+    return netWeight * stnCof;
+  }
+  else if(hasCustomNetWeight) {
+    return net->customWeight * stnCof;
+  }
+  else if(isTiming && netWeightApply && net->timingWeight > 0) {
+    return net->timingWeight * stnCof;
+  }
+  return stnCof;
+}
+
+static inline prec GetWaExp(prec a) {
+  return isWlenSimd ? SimdExp(a) : get_exp(a);
+}
+
+// Closed-form WA for nets of a fixed degree. Pin coordinates, exponentials
+// and sums stay in registers; only the per-slot gradient (already scaled
+// by the net weight) and the net sums are stored. Returns the net's HPWL.
+template < int DEG >
+static FPOS NetUpdateWaFixed(PLACE_GRAPH *g, int n, FPOS *st) {
+  NET *net = &netInstance[n];
+  int s0 = g->netStart[n];
+  prec x[DEG], y[DEG];
+  FPOS netMin = net->terminalMin, netMax = net->terminalMax;
+
+  for(int k = 0; k < DEG; k++) {
+    int moduleID = g->pinModule[s0 + k];
+    if(moduleID >= 0) {
+      x[k] = st[moduleID].x + g->pof[s0 + k].x;
+      y[k] = st[moduleID].y + g->pof[s0 + k].y;
+      g->fp[s0 + k] = FPOS(x[k], y[k]);
+    }
+    else {
+      x[k] = g->fp[s0 + k].x;
+      y[k] = g->fp[s0 + k].y;
+    }
+    netMin.x = min(netMin.x, x[k]);
+    netMin.y = min(netMin.y, y[k]);
+    netMax.x = max(netMax.x, x[k]);
+    netMax.y = max(netMax.y, y[k]);
+  }
+
+  SetNetBox(g, net, n, netMin, netMax);
+
+  prec e1x[DEG], e1y[DEG], e2x[DEG], e2y[DEG];
+  prec num1x = 0, num1y = 0, num2x = 0, num2y = 0;
+  prec den1x = 0, den1y = 0, den2x = 0, den2y = 0;
+
+  for(int k = 0; k < DEG; k++) {
+    prec exp_max_x = (x[k] - netMax.x) * wlen_cof.x;
+    prec exp_min_x = (netMin.x - x[k]) * wlen_cof.x;
+    prec exp_max_y = (y[k] - netMax.y) * wlen_cof.y;
+    prec exp_min_y = (netMin.y - y[k]) * wlen_cof.y;
+
+    e1x[k] = (exp_max_x > NEG_MAX_EXP) ? GetWaExp(exp_max_x) : 0;
+    e2x[k] = (exp_min_x > NEG_MAX_EXP) ? GetWaExp(exp_min_x) : 0;
+    e1y[k] = (exp_max_y > NEG_MAX_EXP) ? GetWaExp(exp_max_y) : 0;
+    e2y[k] = (exp_min_y > NEG_MAX_EXP) ? GetWaExp(exp_min_y) : 0;
+
+    num1x += x[k] * e1x[k];
+    num1y += y[k] * e1y[k];
+    num2x += x[k] * e2x[k];
+    num2y += y[k] * e2y[k];
+    den1x += e1x[k];
+    den1y += e1y[k];
+    den2x += e2x[k];
+    den2y += e2y[k];
+  }
+
+  g->sumNum1[n] = FPOS(num1x, num1y);
+  g->sumNum2[n] = FPOS(num2x, num2y);
+  g->sumDenom1[n] = FPOS(den1x, den1y);
+  g->sumDenom2[n] = FPOS(den2x, den2y);
+
+  // d/dx of num1/den1 - num2/den2, same algebra as get_net_wlen_grad_wa
+  prec inv1x = 1.0 / den1x, inv1y = 1.0 / den1y;
+  prec inv2x = 1.0 / den2x, inv2y = 1.0 / den2y;
+  prec wa1x = num1x * inv1x, wa1y = num1y * inv1y;
+  prec wa2x = num2x * inv2x, wa2y = num2y * inv2y;
+  prec weight = g->netWeight[n] = GetWaNetWeight(g, n);
+
+  for(int k = 0; k < DEG; k++) {
+    FPOS grad;
+    grad.x = e1x[k] * inv1x * (1.0 + wlen_cof.x * (x[k] - wa1x)) -
+             e2x[k] * inv2x * (1.0 - wlen_cof.x * (x[k] - wa2x));
+    grad.y = e1y[k] * inv1y * (1.0 + wlen_cof.y * (y[k] - wa1y)) -
+             e2y[k] * inv2y * (1.0 - wlen_cof.y * (y[k] - wa2y));
+    g->pinGrad[s0 + k] = FPOS(grad.x * weight, grad.y * weight);
+  }
+
+  return FPOS(netMax.x - netMin.x, netMax.y - netMin.y);
+}
+
+static FPOS NetUpdateWaGeneric(PLACE_GRAPH *g, int n, FPOS *st) {
+  NET *net = &netInstance[n];
+  int s0 = g->netStart[n], s1 = g->netStart[n + 1];
+  FPOS netMin = net->terminalMin, netMax = net->terminalMax;
+
+  for(int s = s0; s < s1; s++) {
+    int moduleID = g->pinModule[s];
+    if(moduleID < 0)
+      continue;
+
+    FPOS fp;
+    fp.x = st[moduleID].x + g->pof[s].x;
+    fp.y = st[moduleID].y + g->pof[s].y;
+    g->fp[s] = fp;
+
+    netMin.x = min(netMin.x, fp.x);
+    netMin.y = min(netMin.y, fp.y);
+    netMax.x = max(netMax.x, fp.x);
+    netMax.y = max(netMax.y, fp.y);
+  }
+
+  SetNetBox(g, net, n, netMin, netMax);
+
+  if(isWlenSimd) {
+    net_update_wa_simd(g, n, netMin, netMax);
+  }
+  else {
+    FPOS sum_num1, sum_num2;
+    FPOS sum_denom1, sum_denom2;
+
+    for(int s = s0; s < s1; s++) {
+      FPOS fp = g->fp[s];
+      prec exp_max_x = (fp.x - netMax.x) * wlen_cof.x;
+      prec exp_min_x = (netMin.x - fp.x) * wlen_cof.x;
+      prec exp_max_y = (fp.y - netMax.y) * wlen_cof.y;
+      prec exp_min_y = (netMin.y - fp.y) * wlen_cof.y;
+      FPOS e1, e2;
+
+      if(exp_max_x > NEG_MAX_EXP) {
+        e1.x = get_exp(exp_max_x);
+        sum_num1.x += fp.x * e1.x;
+        sum_denom1.x += e1.x;
+      }
+      if(exp_min_x > NEG_MAX_EXP) {
+        e2.x = get_exp(exp_min_x);
+        sum_num2.x += fp.x * e2.x;
+        sum_denom2.x += e2.x;
+      }
+      if(exp_max_y > NEG_MAX_EXP) {
+        e1.y = get_exp(exp_max_y);
+        sum_num1.y += fp.y * e1.y;
+        sum_denom1.y += e1.y;
+      }
+      if(exp_min_y > NEG_MAX_EXP) {
+        e2.y = get_exp(exp_min_y);
+        sum_num2.y += fp.y * e2.y;
+        sum_denom2.y += e2.y;
+      }
+
+      g->e1[s] = e1;
+      g->e2[s] = e2;
+    }
+
+    g->sumNum1[n] = sum_num1;
+    g->sumNum2[n] = sum_num2;
+    g->sumDenom1[n] = sum_denom1;
+    g->sumDenom2[n] = sum_denom2;
+  }
+
+  g->netWeight[n] = GetWaNetWeight(g, n);
+
+  // -wlNetGrad: emit the weighted pin gradients while the net is hot
+  if(isWlenNetGrad) {
+    prec weight = g->netWeight[n];
+    for(int s = s0; s < s1; s++) {
+      FPOS grad;
+      if(s1 - s0 > 1) {
+        get_net_wlen_grad_wa(g, n, s, &grad);
+      }
+      g->pinGrad[s] = FPOS(grad.x * weight, grad.y * weight);
+    }
+  }
+
+  // single-pin nets do not count towards HPWL
+  if(s1 - s0 <= 1)
+    return FPOS(0, 0);
+  return FPOS(netMax.x - netMin.x, netMax.y - netMin.y);
+}
+
+// -hfNet: WA of a high-fanout net from the HIGH_FANOUT_KEEP_PINS pins
+// closest to each bbox side (partial selection); every other pin gets a
+// zero gradient on that side. The pins are re-selected whenever any pin
+// of the net moved, so the cached selection is only reused for a repeated
+// evaluation at the same positions.
+static FPOS NetUpdateWaHighFanout(PLACE_GRAPH *g, int n, int hfIdx,
+                                  FPOS *st) {
+  NET *net = &netInstance[n];
+  int s0 = g->netStart[n], s1 = g->netStart[n + 1];
+  FPOS netMin = net->terminalMin, netMax = net->terminalMax;
+  bool isMoved = false;
+
+  for(int s = s0; s < s1; s++) {
+    int moduleID = g->pinModule[s];
+    if(moduleID < 0)
+      continue;
+
+    FPOS fp;
+    fp.x = st[moduleID].x + g->pof[s].x;
+    fp.y = st[moduleID].y + g->pof[s].y;
+    if(fp.x != g->fp[s].x || fp.y != g->fp[s].y) {
+      isMoved = true;
+    }
+    g->fp[s] = fp;
+    g->pinGrad[s].SetZero();
+
+    netMin.x = min(netMin.x, fp.x);
+    netMin.y = min(netMin.y, fp.y);
+    netMax.x = max(netMax.x, fp.x);
+    netMax.y = max(netMax.y, fp.y);
+  }
+
+  SetNetBox(g, net, n, netMin, netMax);
+
+  const int keep = HIGH_FANOUT_KEEP_PINS;
+  int *sel = &g->hfSel[4 * keep * hfIdx];
+
+  if(!g->hfValid[hfIdx] || isMoved) {
+    std::vector< int > slots(s1 - s0);
+    FPOS *fp = g->fp;
+
+    // sides: 0 max x, 1 min x, 2 max y, 3 min y
+    for(int side = 0; side < 4; side++) {
+      for(int s = s0; s < s1; s++) {
+        slots[s - s0] = s;
+      }
+      std::nth_element(slots.begin(), slots.begin() + keep, slots.end(),
+                       [fp, side](int a, int b) {
+                         switch(side) {
+                           case 0:
+                             return fp[a].x > fp[b].x;
+                           case 1:
+                             return fp[a].x < fp[b].x;
+                           case 2:
+                             return fp[a].y > fp[b].y;
+                           default:
+                             return fp[a].y < fp[b].y;
+                         }
+                       });
+      std::copy(slots.begin(), slots.begin() + keep, sel + side * keep);
+    }
+    g->hfValid[hfIdx] = true;
+  }
+
+  prec e[4][HIGH_FANOUT_KEEP_PINS];
+  prec num[4] = {0, }, den[4] = {0, };
+
+  for(int side = 0; side < 4; side++) {
+    for(int k = 0; k < keep; k++) {
+      FPOS fp = g->fp[sel[side * keep + k]];
+      prec v = (side < 2) ? fp.x : fp.y;
+      prec a = 0;
+      switch(side) {
+        case 0:
+          a = (fp.x - netMax.x) * wlen_cof.x;
+          break;
+        case 1:
+          a = (netMin.x - fp.x) * wlen_cof.x;
+          break;
+        case 2:
+          a = (fp.y - netMax.y) * wlen_cof.y;
+          break;
+        default:
+          a = (netMin.y - fp.y) * wlen_cof.y;
+          break;
+      }
+      e[side][k] = (a > NEG_MAX_EXP) ? GetWaExp(a) : 0;
+      num[side] += v * e[side][k];
+      den[side] += e[side][k];
+    }
+  }
+
+  g->sumNum1[n] = FPOS(num[0], num[2]);
+  g->sumNum2[n] = FPOS(num[1], num[3]);
+  g->sumDenom1[n] = FPOS(den[0], den[2]);
+  g->sumDenom2[n] = FPOS(den[1], den[3]);
+
+  prec weight = g->netWeight[n] = GetWaNetWeight(g, n);
+
+  // same closed form as NetUpdateWaFixed, one side at a time
+  for(int side = 0; side < 4; side++) {
+    prec cof = (side < 2) ? wlen_cof.x : wlen_cof.y;
+    prec inv = 1.0 / den[side];
+    prec wa = num[side] * inv;
+    prec sign = (side % 2 == 0) ? 1.0 : -1.0;
+
+    for(int k = 0; k < keep; k++) {
+      int s = sel[side * keep + k];
+      prec v = (side < 2) ? g->fp[s].x : g->fp[s].y;
+      prec grad = sign * weight * e[side][k] * inv *
+                  (1.0 + sign * cof * (v - wa));
+      if(side < 2) {
+        g->pinGrad[s].x += grad;
+      }
+      else {
+        g->pinGrad[s].y += grad;
+      }
+    }
+  }
+
+  return FPOS(netMax.x - netMin.x, netMax.y - netMin.y);
+}
+
 // WA
 //
-void net_update_wa(FPOS *st) {
-  int i = 0;
-
+void net_update_wa(FPOS *st, bool isCellUpdate) {
   bool timeon = false;
   double time = 0.0f;
   if(timeon)
     time_start(&time);
 
-  omp_set_num_threads(numThread);
-#pragma omp parallel default(none) shared(gcell_cnt, gcell_st, st) private(i)
-  {
-//        CELL* cell = NULL;
-#pragma omp for
-    for(i = 0; i < gcell_cnt; i++) {
-      CELL *cell = &gcell_st[i];
-      cell->center = st[i];
-      cell->den_pmin.x = cell->center.x - cell->half_den_size.x;
-      cell->den_pmin.y = cell->center.y - cell->half_den_size.y;
-      cell->den_pmax.x = cell->center.x + cell->half_den_size.x;
-      cell->den_pmax.y = cell->center.y + cell->half_den_size.y;
-    }
+  if(isCellUpdate) {
+    net_update_cells(st);
   }
   if(timeon) {
     time_end(&time);
     cout << "parallelTime : " << time << endl;
   }
-//  wlen_cof.Dump("current_wlen_cof"); 
-//  cout << "NEG_MAX_EXP: " << NEG_MAX_EXP << endl;
 
-#pragma omp parallel default(none) shared( \
-    netInstance, moduleInstance, st, netCNT, NEG_MAX_EXP, wlen_cof) private(i)
-  {
-//        NET *net = NULL;
-//        PIN *pin = NULL;
-//        MODULE *curModule = NULL;
-//        prec exp_min_x = 0, exp_min_y = 0;
-//        prec exp_max_x = 0, exp_max_y = 0;
-//        prec min_x = 0, min_y = 0;
-//        prec max_x = 0, max_y = 0;
+  total_hpwl = net_update_wa_graph(place_graph, st);
+}
 
-//        FPOS fp, pof, center;
-//        FPOS sum_num1, sum_num2, sum_denom1, sum_denom2;
+// WA pass over g at st; returns the HPWL
+FPOS net_update_wa_graph(PLACE_GRAPH *g, FPOS *st) {
+  int i = 0;
 
+  // Walks the flat place_graph arrays bucket by bucket (see
+  // place_graph_build): 2- and 3-pin nets take the unrolled kernels,
+  // everything else the generic two-pass loop.
+  //
+  // Note that NEG_MAX_EXP is -300; a clipped exponential is stored as 0.
+  // we know that wlen_cof is 1/ gamma.
+  // See main.cpp wcof00 and wlen.cpp: wcof_init.
+  //
+  // HPWL of the updated bounds is kept per bucket slot and summed in
+  // slot order afterwards, so GetHpwl() needs no second pass over the
+  // nets and the total does not depend on -t
+  FPOS *val = g->netVal;
+  omp_set_num_threads(wlenThread);
+#pragma omp parallel default(none) \
+    shared(g, st, isWlenNetGrad, val) private(i)
+  {
+#pragma omp for nowait
+    for(i = g->bucketStart[WA_BUCKET_DEG2];
+        i < g->bucketStart[WA_BUCKET_DEG2 + 1]; i++) {
+      val[i] = NetUpdateWaFixed< 2 >(g, g->netBucket[i], st);
+    }
+#pragma omp for nowait
+    for(i = g->bucketStart[WA_BUCKET_DEG3];
+        i < g->bucketStart[WA_BUCKET_DEG3 + 1]; i++) {
+      val[i] = NetUpdateWaFixed< 3 >(g, g->netBucket[i], st);
+    }
+#pragma omp for nowait
+    for(i = g->bucketStart[WA_BUCKET_HIGH_FANOUT];
+        i < g->bucketStart[WA_BUCKET_HIGH_FANOUT + 1]; i++) {
+      val[i] = NetUpdateWaHighFanout(
+          g, g->netBucket[i], i - g->bucketStart[WA_BUCKET_HIGH_FANOUT], st);
+    }
 #pragma omp for
-    for(i = 0; i < netCNT; i++) {
-      NET *net = &netInstance[i];
-      net->min_x = net->terminalMin.x;
-      net->min_y = net->terminalMin.y;
-      net->max_x = net->terminalMax.x;
-      net->max_y = net->terminalMax.y;
-
-      //        cout << "size: " << sizeof(PIN) << endl;
-      //        cout << net->pinCNTinObject << endl;
-      for(int j = 0; j < net->pinCNTinObject; j++) {
-        PIN *pin = net->pin[j];
-
-        //            cout << j << " " << pin << endl;
-
-        if(!pin->term) {
-          MODULE *curModule = &moduleInstance[pin->moduleID];
-          FPOS pof = curModule->pof[pin->pinIDinModule];
-          FPOS center = st[pin->moduleID];
-          FPOS fp;
-          fp.x = center.x + pof.x;
-          fp.y = center.y + pof.y;
-          pin->fp = fp;
-
-          net->min_x = min(net->min_x, fp.x);
-          net->min_y = min(net->min_y, fp.y);
-          net->max_x = max(net->max_x, fp.x);
-          net->max_y = max(net->max_y, fp.y);
-        }
-        else {
-          continue;
-        }
-      }
-      //        if( i >=2 )
-      //        exit(1);
-
-      prec min_x = net->min_x;
-      prec min_y = net->min_y;
-      prec max_x = net->max_x;
-      prec max_y = net->max_y;
-
-      FPOS sum_num1, sum_num2;
-      FPOS sum_denom1, sum_denom2;
-
-      // UPDATE
-      // pin->e1 (MAX)
-      // net->sum_num1 (MAX)
-      // net->sum_denom1 (MAX)
-      // pin->flg1 (MAX)
-      //
-      // pin->e2 (MIN)
-      // net->sum_num2 (MIN)
-      // net->sum_denom2 (MIN)
-      // pin->flg2 (MIN)
-      //
-      //
-      // Note that NEG_MAX_EXP is -300
-      // The meaning NEG_MAX_EXP is. not to have weird out of range values 
-      // in floating vars.
-      //
-      // we know that wlen_cof is 1/ gamma.
-      // See main.cpp wcof00 and wlen.cpp: wcof_init. 
-      //
-      
-      for(int j = 0; j < net->pinCNTinObject; j++) {
-        PIN *pin = net->pin[j];
-        FPOS fp = pin->fp;
-        prec exp_max_x = (fp.x - max_x) * wlen_cof.x;
-        prec exp_min_x = (min_x - fp.x) * wlen_cof.x;
-        prec exp_max_y = (fp.y - max_y) * wlen_cof.y;
-        prec exp_min_y = (min_y - fp.y) * wlen_cof.y;
-
-
-        if(exp_max_x > NEG_MAX_EXP) {
-          pin->e1.x = get_exp(exp_max_x);
-          sum_num1.x += fp.x * pin->e1.x;
-          sum_denom1.x += pin->e1.x;
-          pin->flg1.x = 1;
-        }
-        else {
-          pin->flg1.x = 0;
-        }
-
-        if(exp_min_x > NEG_MAX_EXP) {
-          pin->e2.x = get_exp(exp_min_x);
-          sum_num2.x += fp.x * pin->e2.x;
-          sum_denom2.x += pin->e2.x;
-          pin->flg2.x = 1;
-        }
-        else {
-          pin->flg2.x = 0;
-        }
-
-        if(exp_max_y > NEG_MAX_EXP) {
-          pin->e1.y = get_exp(exp_max_y);
-          sum_num1.y += fp.y * pin->e1.y;
-          sum_denom1.y += pin->e1.y;
-          pin->flg1.y = 1;
-        }
-        else {
-          pin->flg1.y = 0;
-        }
+    for(i = g->bucketStart[WA_BUCKET_GENERIC];
+        i < g->bucketStart[WA_BUCKET_GENERIC + 1]; i++) {
+      val[i] = NetUpdateWaGeneric(g, g->netBucket[i], st);
+    }
 
-        if(exp_min_y > NEG_MAX_EXP) {
-          pin->e2.y = get_exp(exp_min_y);
-          sum_num2.y += fp.y * pin->e2.y;
-          sum_denom2.y += pin->e2.y;
-          pin->flg2.y = 1;
-        }
-        else {
-          pin->flg2.y = 0;
+    // segmented reduction of pinGrad over the cell -> slot CSR
+    if(isWlenNetGrad) {
+#pragma omp for
+      for(i = 0; i < g->cellCnt; i++) {
+        FPOS sum;
+        for(int k = g->cellStart[i]; k < g->cellStart[i + 1]; k++) {
+          sum.x += g->pinGrad[g->cellSlot[k]].x;
+          sum.y += g->pinGrad[g->cellSlot[k]].y;
         }
+        g->cellGrad[i] = sum;
       }
-
-      net->sum_num1 = sum_num1;
-      net->sum_num2 = sum_num2;
-      net->sum_denom1 = sum_denom1;
-      net->sum_denom2 = sum_denom2;
     }
   }
+
+  return SumGraphNetVal(g);
+}
+
+// -wlSimd variant of the per-net WA sums: the four exponentials of a pin
+// are evaluated with SimdExp and the clipped ones masked to 0, so the pin
+// loop has no branches and runs across the net's slots in vector lanes.
+void net_update_wa_simd(PLACE_GRAPH *g, int netIdx, FPOS netMin,
+                        FPOS netMax) {
+  int s0 = g->netStart[netIdx], s1 = g->netStart[netIdx + 1];
+  prec *fp = (prec *)g->fp;
+  prec *e1 = (prec *)g->e1;
+  prec *e2 = (prec *)g->e2;
+  prec cofX = wlen_cof.x, cofY = wlen_cof.y;
+  prec minX = netMin.x, minY = netMin.y;
+  prec maxX = netMax.x, maxY = netMax.y;
+  prec negMaxExp = NEG_MAX_EXP;
+
+  prec num1X = 0, num1Y = 0, num2X = 0, num2Y = 0;
+  prec den1X = 0, den1Y = 0, den2X = 0, den2Y = 0;
+
+#pragma omp simd reduction(+ : num1X, num1Y, num2X, num2Y, den1X, den1Y, \
+                           den2X, den2Y)
+  for(int s = s0; s < s1; s++) {
+    prec x = fp[2 * s], y = fp[2 * s + 1];
+    prec aMaxX = (x - maxX) * cofX;
+    prec aMinX = (minX - x) * cofX;
+    prec aMaxY = (y - maxY) * cofY;
+    prec aMinY = (minY - y) * cofY;
+
+    prec e1X = SimdExp(aMaxX);
+    prec e2X = SimdExp(aMinX);
+    prec e1Y = SimdExp(aMaxY);
+    prec e2Y = SimdExp(aMinY);
+
+    e1X = (aMaxX > negMaxExp) ? e1X : 0;
+    e2X = (aMinX > negMaxExp) ? e2X : 0;
+    e1Y = (aMaxY > negMaxExp) ? e1Y : 0;
+    e2Y = (aMinY > negMaxExp) ? e2Y : 0;
+
+    e1[2 * s] = e1X;
+    e1[2 * s + 1] = e1Y;
+    e2[2 * s] = e2X;
+    e2[2 * s + 1] = e2Y;
+
+    num1X += x * e1X;
+    num1Y += y * e1Y;
+    num2X += x * e2X;
+    num2Y += y * e2Y;
+    den1X += e1X;
+    den1Y += e1Y;
+    den2X += e2X;
+    den2Y += e2Y;
+  }
+
+  g->sumNum1[netIdx] = FPOS(num1X, num1Y);
+  g->sumNum2[netIdx] = FPOS(num2X, num2Y);
+  g->sumDenom1[netIdx] = FPOS(den1X, den1Y);
+  g->sumDenom2[netIdx] = FPOS(den2X, den2Y);
 }
 
 prec get_mac_hpwl(int idx) {
@@ -1136,27 +1778,34 @@ void UpdateNetMinMaxPin2(void) {
 // Get HPWL as micron units
 pair<double, double> GetUnscaledHpwl() {
   double x = 0.0f, y = 0.0f;
+  int i = 0;
+  FPOS *val = GetNetValBuf(netCNT);
 
-  NET *curNet = NULL;
-  for(int i = 0; i < netCNT; i++) {
-    curNet = &netInstance[i];
-    x += (curNet->max_x - curNet->min_x) * GetUnitX() / GetDefDbu();
-    y += (curNet->max_y - curNet->min_y) * GetUnitY() / GetDefDbu();
+  omp_set_num_threads(wlenThread);
+#pragma omp parallel for default(none) \
+    shared(netCNT, netInstance, cout, val) private(i)
+  for(i = 0; i < netCNT; i++) {
+    NET *curNet = &netInstance[i];
+    val[i].x = curNet->max_x - curNet->min_x;
+    val[i].y = curNet->max_y - curNet->min_y;
 
-    if(curNet->max_x - curNet->min_x < 0) {
-      cout << "NEGATIVE HPWL ERROR! " << curNet->Name() << " " << curNet->max_x
-           << " " << curNet->min_x << endl;
-    }
-    if(curNet->max_y - curNet->min_y < 0) {
-      cout << "NEGATIVE HPWL ERROR! " << curNet->Name() << " " << curNet->max_y
+    if(curNet->max_x - curNet->min_x < 0 || curNet->max_y - curNet->min_y < 0) {
+#pragma omp critical
+      cout << "NEGATIVE HPWL ERROR! " << curNet->Name() << " "
+           << curNet->max_x << " " << curNet->min_x << " " << curNet->max_y
            << " " << curNet->min_y << endl;
     }
+  }
 
-    if(x < 0 || y < 0) {
-      printf("NEGATIVE HPWL ERROR! \n");
-      cout << curNet->Name() << x << " " << y << endl;
-      exit(1);
-    }
+  prec_acc sumX, sumY;
+  SumNetVal(netCNT, &sumX, &sumY);
+  x = sumX * GetUnitX() / GetDefDbu();
+  y = sumY * GetUnitY() / GetDefDbu();
+
+  if(x < 0 || y < 0) {
+    printf("NEGATIVE HPWL ERROR! \n");
+    cout << x << " " << y << endl;
+    exit(1);
   }
   return make_pair(x, y);
 }
@@ -71,21 +71,96 @@ struct EXP_ST {
   prec y_h;
 };
 
+// Degree buckets of the WA update. 2- and 3-pin nets (most of the
+// netlist) get unrolled kernels that keep the exponentials in registers.
+// With -hfNet, nets above the fanout threshold go to WA_BUCKET_HIGH_FANOUT.
+enum {
+  WA_BUCKET_DEG2,
+  WA_BUCKET_DEG3,
+  WA_BUCKET_GENERIC,
+  WA_BUCKET_HIGH_FANOUT,
+  WA_BUCKET_CNT
+};
+#define WA_FIXED_DEG_MAX 3
+
+// block size of the fixed-order per-net sums (HPWL, LSE wirelength)
+#define WLEN_SUM_BLOCK 1024
+
+// high-fanout nets: WA terms are kept for this many pins per bbox side
+#define HIGH_FANOUT_KEEP_PINS 16
+
+// Flat netlist view for the wirelength kernels. Pin slots are numbered
+// net by net (CSR); the topology is fixed once cell_init() has dropped
+// duplicated pins, so it is built at the end of setup_before_opt().
+struct PLACE_GRAPH {
+  int netCnt;
+  int pinCnt;
+  int cellCnt;  // moduleCNT; fillers have no pins
+
+  int *netStart;   // netCnt + 1
+  int *pinModule;  // per slot: moduleID (index into st), -1 for terminals
+  FPOS *pof;       // per slot: offset to the module center
+  FPOS *fp;        // per slot: pin location (fixed for terminals)
+  FPOS *e1;        // per slot: max-side exponential, 0 when clipped
+                   // (not written by the 2/3-pin WA kernels)
+  FPOS *e2;        // per slot: min-side exponential, 0 when clipped
+  FPOS *pinGrad;   // per slot: weighted WA gradient of 2/3-pin and
+                   // high-fanout nets, of every net with -wlNetGrad;
+                   // LSE gradient of every net under -wlmodel lse
+
+  FPOS *netMin;    // per net, from the last net_update()
+  FPOS *netMax;
+  FPOS *sumNum1;
+  FPOS *sumNum2;
+  FPOS *sumDenom1;
+  FPOS *sumDenom2;
+  prec *netWeight; // unit / custom / timing weight of the WA gradient
+  prec *stnCof;    // -wlmodel stn: RSMT / HPWL estimate by degree
+
+  int *netBucket;  // net indices grouped by WA_BUCKET_*
+  int bucketStart[WA_BUCKET_CNT + 1];
+  unsigned char *netKind;  // WA_BUCKET_* of each net
+
+  // per high-fanout net (bucket order): the near-extreme pin slots,
+  // HIGH_FANOUT_KEEP_PINS per side, reused while no pin of the net moved
+  int *hfSel;
+  bool *hfValid;
+
+  int *cellStart;  // cellCnt + 1
+  int *cellSlot;   // pin slots of each cell
+  int *cellNet;    // net of each of those slots
+  FPOS *cellGrad;  // -wlNetGrad: per cell sum of pinGrad
+
+  FPOS *netVal;         // per net HPWL of the last update, in bucket order
+  prec_acc *netValBlk;  // block sums of netVal
+  bool isNetSync;       // net passes write the bboxes to netInstance
+                        // (false for -specStep clones)
+};
+
+extern PLACE_GRAPH *place_graph;
+
+void place_graph_build(void);
+void place_graph_delete(void);
+PLACE_GRAPH *place_graph_clone(void);
+void place_graph_clone_delete(PLACE_GRAPH *g);
+void place_graph_adopt(PLACE_GRAPH *g);
+
 extern EXP_ST *exp_st;
 
 prec get_wlen();
 prec get_wlen_wa();
 prec get_wlen_lse(void);
+prec get_wlen_stn(void);
 void SetMAX_EXP_wlen();
 
 FPOS get_net_wlen_wa(NET *net);
 FPOS get_net_wlen_lse(NET *net);
 
 void wlen_grad(int cell_idx, FPOS *grad);
-void wlen_grad_lse(int cell_idx, FPOS *grad);
-inline void wlen_grad_wa(int cell_idx, FPOS *grad);
-void get_net_wlen_grad_lse(NET *net, PIN *pin, FPOS *grad);
-inline void get_net_wlen_grad_wa(FPOS obj, NET *net, PIN *pin, FPOS *grad);
+void wlen_grad_lse(PLACE_GRAPH *g, int cell_idx, FPOS *grad);
+void wlen_grad_wa(PLACE_GRAPH *g, int cell_idx, FPOS *grad);
+void get_net_wlen_grad_lse(int netIdx, int slot, FPOS *grad);
+void get_net_wlen_grad_wa(PLACE_GRAPH *g, int netIdx, int slot, FPOS *grad);
 
 
 void initCustomNetWeight(std::string netWeightFile);
@@ -116,7 +191,7 @@ inline void wlen_pre(int cell_idx, FPOS *wpre) {
 void wlen_grad2(int cell_idx, FPOS *grad2);
 void wlen_grad2_lse(int cell_idx, FPOS *grad2);
 void wlen_grad2_wa(FPOS *grad);
-void get_net_wlen_grad2_lse(NET *net, PIN *pin, FPOS *grad2);
+void get_net_wlen_grad2_lse(int netIdx, int slot, FPOS *grad2);
 
 FPOS get_wlen_cof(prec ovf);
 FPOS get_wlen_cof1(prec ovf);
@@ -133,15 +208,93 @@ void wlen_grad_debug(FPOS grad);
 inline prec get_exp(prec a) {
   return fastExp(a);
 }
+
+// -wlSimd: branch-free exp for the vectorized WA kernel, one overload per
+// prec so PREC_DOUBLE builds keep double accuracy.
+// Cody-Waite reduction to [-ln2/2, ln2/2] and the cephes degree-6
+// polynomial; relative error below 2e-7 on [SIMD_EXP_MIN, 88].
+#define SIMD_EXP_MIN -87.0f
+
+#pragma omp declare simd notinbranch
+inline float SimdExp(float a) {
+  // clamp arithmetically; a float ?: here gets jump-threaded into
+  // constant branches and the caller's loop no longer vectorizes
+  float lo = (float)(a < SIMD_EXP_MIN);
+  float hi = (float)(a > 88.0f);
+  a = a * (1.0f - lo - hi) + SIMD_EXP_MIN * lo + 88.0f * hi;
+
+  // n = floor(a / ln2 + 0.5) with a truncating cast
+  float t = a * 1.44269504f + 0.5f;
+  int n = (int)t;
+  n -= (t < (float)n);
+  float r = a - (float)n * 0.693359375f;
+  r = r + (float)n * 2.12194440e-4f;
+
+  float p = 1.9875691500e-4f;
+  p = p * r + 1.3981999507e-3f;
+  p = p * r + 8.3334519073e-3f;
+  p = p * r + 4.1665795894e-2f;
+  p = p * r + 1.6666665459e-1f;
+  p = p * r + 5.0000001201e-1f;
+  p = p * r * r + r + 1.0f;
+
+  // 2^n straight into the exponent field
+  int32_t bits = (n + 127) << 23;
+  float scale;
+  memcpy(&scale, &bits, sizeof(float));
+  return p * scale;
+}
+
+// double exp for PREC_DOUBLE builds: the cephes Pade form
+// 1 + 2 r P(r^2) / (Q(r^2) - r P(r^2)), relative error below 4e-16 on
+// [SIMD_EXPD_MIN, SIMD_EXPD_MAX].
+#define SIMD_EXPD_MIN -708.0
+#define SIMD_EXPD_MAX 709.0
+
+#pragma omp declare simd notinbranch
+inline double SimdExp(double a) {
+  double lo = (double)(a < SIMD_EXPD_MIN);
+  double hi = (double)(a > SIMD_EXPD_MAX);
+  a = a * (1.0 - lo - hi) + SIMD_EXPD_MIN * lo + SIMD_EXPD_MAX * hi;
+
+  double t = a * 1.4426950408889634 + 0.5;
+  int n = (int)t;
+  n -= (t < (double)n);
+  double r = a - (double)n * 6.93145751953125e-1;
+  r = r - (double)n * 1.42860682030941723212e-6;
+
+  double rr = r * r;
+  double p = 1.26177193074810590878e-4;
+  p = p * rr + 3.02994407707441961300e-2;
+  p = p * rr + 9.99999999999999999910e-1;
+  p = p * r;
+  double q = 3.00198505138664455042e-6;
+  q = q * rr + 2.52448340349684104192e-3;
+  q = q * rr + 2.27265548208155028766e-1;
+  q = q * rr + 2.00000000000000000009e0;
+  p = 1.0 + 2.0 * p / (q - p);
+
+  int64_t bits = (int64_t)(n + 1023) << 52;
+  double scale;
+  memcpy(&scale, &bits, sizeof(double));
+  return p * scale;
+}
 void wlen_init(void);
 void wlen_init_mGP2D(void);
 void wlen_init_cGP2D(void);
 void wcof_init(FPOS bstp);
 
 void net_update_init(void);
-void net_update(FPOS *st);
-void net_update_lse(FPOS *st);
-void net_update_wa(FPOS *st);
+void net_update(FPOS *st, bool isCellUpdate = true);
+void net_update_cells(FPOS *st);
+void net_update_lse(FPOS *st, bool isCellUpdate = true);
+void net_update_wa(FPOS *st, bool isCellUpdate = true);
+void net_update_wa_simd(PLACE_GRAPH *g, int netIdx, FPOS netMin, FPOS netMax);
+// same passes on a given graph, without touching the gcells or
+// total_hpwl (netInstance only if g->isNetSync). Return the HPWL.
+FPOS net_update_graph(PLACE_GRAPH *g, FPOS *st);
+FPOS net_update_wa_graph(PLACE_GRAPH *g, FPOS *st);
+FPOS net_update_lse_graph(PLACE_GRAPH *g, FPOS *st);
 
 prec GetHpwl();
 prec UpdateNetAndGetHpwl();
@@ -162,14 +315,64 @@ prec net_update_hpwl_mac(void);
 void UpdateNetMinMaxPin2();
 void update_pin2(void);
 
-enum { LSE, WA };
+enum { LSE, WA, STN };
 
 
 std::pair<double, double> GetUnscaledHpwl();
 void PrintUnscaledHpwl(std::string mode);
 
+// Wirelength model policies. The per-cell cost-gradient loops in ns.cpp
+// are instantiated with one of these, so the model is picked once per
+// call instead of once per cell.
+struct WlenWA {
+  static void NetUpdate(FPOS *st, bool isCellUpdate) {
+    net_update_wa(st, isCellUpdate);
+  }
+  static prec Wlen() { return get_wlen_wa(); }
+  static void Grad(PLACE_GRAPH *g, int cell_idx, FPOS *grad) {
+    wlen_grad_wa(g, cell_idx, grad);
+  }
+  static void Grad2(int, FPOS *grad2) { wlen_grad2_wa(grad2); }
+};
+
+struct WlenLSE {
+  static void NetUpdate(FPOS *st, bool isCellUpdate) {
+    net_update_lse(st, isCellUpdate);
+  }
+  static prec Wlen() { return get_wlen_lse(); }
+  static void Grad(PLACE_GRAPH *g, int cell_idx, FPOS *grad) {
+    wlen_grad_lse(g, cell_idx, grad);
+  }
+  static void Grad2(int cell_idx, FPOS *grad2) {
+    wlen_grad2_lse(cell_idx, grad2);
+  }
+};
 
-#define WLEN_MODEL WA /* LSE */ /* NTU */
+// Steiner-aware WA: each net's WA is scaled by the expected RSMT / HPWL
+// ratio of its degree (place_graph->stnCof, folded into netWeight)
+struct WlenSTN {
+  static void NetUpdate(FPOS *st, bool isCellUpdate) {
+    net_update_wa(st, isCellUpdate);
+  }
+  static prec Wlen() { return get_wlen_stn(); }
+  static void Grad(PLACE_GRAPH *g, int cell_idx, FPOS *grad) {
+    wlen_grad_wa(g, cell_idx, grad);
+  }
+  static void Grad2(int, FPOS *grad2) { wlen_grad2_wa(grad2); }
+};
+
+// g is place_graph, or a -specStep candidate's clone of it
+template < class WLEN >
+inline void WlenGrad(PLACE_GRAPH *g, int cell_idx, FPOS *grad) {
+  grad->SetZero();
+#ifdef NO_WLEN
+  return;
+#endif
+
+  WLEN::Grad(g, cell_idx, grad);
+  grad->x *= -1.0 * gp_wlen_weight.x;
+  grad->y *= -1.0 * gp_wlen_weight.y;
+}
 // #define TSV_WEIGHT /* 16.0 */ /* 1.00 */ /* 1.50 */ /* 0.73 */ /* 3.33 */ /*
 // 10.00 */ /* 0.1 */ /* 0.01 */
 
@@ -0,0 +1,33 @@
+# 
+# Deterministic-mode regression: run with DET_THREADS set to the thread
+# count; run_det_test.sh compares the DEFs of two thread counts.
+#
+
+set design gcd
+set lib_dir ../library/nangate45/
+set design_dir ../design/nangate45/${design}
+set threads $::env(DET_THREADS)
+
+replace_external rep
+
+# Import LEF/DEF files
+rep import_lef ${lib_dir}/NangateOpenCellLibrary.lef
+rep import_def ${design_dir}/${design}.def
+rep set_output ./output/
+
+rep set_verbose_level 0
+rep set_number_of_threads ${threads}
+rep set_deterministic 1
+
+# Initialize RePlAce
+rep init_replace
+
+# place_cell with BiCGSTAB 
+rep place_cell_init_place
+
+# place_cell with Nesterov method
+rep place_cell_nesterov_place
+
+# Export DEF file
+rep export_def ./exp/${design}_det_t${threads}.def
+puts "Final HPWL: [rep get_hpwl]"
@@ -0,0 +1,24 @@
+#!/bin/bash
+# -det must give a byte-identical DEF at any thread count.
+# usage (from test/det-test): ./run_det_test.sh [replace binary]
+
+REPLACE=${1:-../replace}
+cd "$(dirname "$0")"
+mkdir -p exp
+ln -sf ../POWV9.dat ./
+
+for t in 1 4; do
+  DET_THREADS=$t $REPLACE < gcd_det_test.tcl > exp/gcd_det_t$t.log 2>&1
+  if [ ! -f exp/gcd_det_t$t.def ]; then
+    echo "FAIL: no DEF for $t thread(s), see exp/gcd_det_t$t.log"
+    exit 1
+  fi
+done
+
+if cmp -s exp/gcd_det_t1.def exp/gcd_det_t4.def; then
+  echo "PASS: gcd DEF identical at 1 and 4 threads"
+  exit 0
+fi
+echo "FAIL: gcd DEF differs between 1 and 4 threads"
+diff exp/gcd_det_t1.def exp/gcd_det_t4.def | head -20
+exit 1
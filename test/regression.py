@@ -36,6 +36,7 @@ def TdRun(tdList):
 if len(sys.argv) <= 1:
   print("Usage: python regression.py run")
   print("Usage: python regression.py skill")
+  print("Usage: python regression.py det")
   print("Usage: python regression.py get")
   sys.exit(0)
 
@@ -50,6 +51,9 @@ for cdir in sorted(dirList):
 
 if sys.argv[1] == "run":
   TdRun(tdList)
+elif sys.argv[1] == "det":
+  # -det: byte-identical DEF at two thread counts
+  ExecuteCommand("./det-test/run_det_test.sh")
 elif sys.argv[1] == "skill":
   ExecuteCommand("for scr in $(screen -ls | awk '{print $1}'); do screen -S $scr -X kill; done")
 else: